@@ -0,0 +1,79 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef COND_VAR_H
+#define COND_VAR_H
+
+#include <ideal_export.h>
+
+#include <core/mutex.h>
+
+namespace IdealCore {
+
+/**
+  * @class CondVar cond_var.h core/cond_var.h
+  *
+  * Lets threads wait until some condition, protected by a Mutex, becomes true.
+  *
+  * @code
+  * ContextMutexLocker cml(mutex);
+  * while (!ready) {
+  *     condVar.wait();
+  * }
+  * @endcode
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT CondVar
+{
+public:
+    /**
+      * Creates a condition variable protected by @p mutex.
+      */
+    CondVar(Mutex &mutex);
+    virtual ~CondVar();
+
+    /**
+      * Unlocks the mutex, waits until signal() or broadcast() is called, and locks the mutex again
+      * before returning. The mutex has to be locked by the calling thread.
+      *
+      * @note It can return without signal() being called, so the condition has to be checked again.
+      */
+    void wait();
+
+    /**
+      * Wakes up one of the threads waiting, if any.
+      */
+    void signal();
+
+    /**
+      * Wakes up all threads waiting.
+      */
+    void broadcast();
+
+private:
+    class Private;
+    class PrivateImpl;
+    Private *d;
+};
+
+}
+
+#endif //COND_VAR_H
@@ -0,0 +1,156 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "connection.h"
+#include "ideal_signal.h"
+
+namespace IdealCore {
+
+Connection::Connection()
+    : m_signal(0)
+    , m_callback(0)
+{
+}
+
+Connection::Connection(const SignalBase *signal, CallbackDummy *callback)
+    : m_signal(signal)
+    , m_callback(callback)
+{
+    m_callback->ref();
+}
+
+Connection::Connection(const Connection &connection)
+    : m_signal(connection.m_signal)
+    , m_callback(connection.m_callback)
+{
+    if (m_callback) {
+        m_callback->ref();
+    }
+}
+
+Connection::~Connection()
+{
+    if (m_callback) {
+        m_callback->deref();
+    }
+}
+
+Connection &Connection::operator=(const Connection &connection)
+{
+    if (connection.m_callback) {
+        connection.m_callback->ref();
+    }
+    if (m_callback) {
+        m_callback->deref();
+    }
+    m_signal = connection.m_signal;
+    m_callback = connection.m_callback;
+    return *this;
+}
+
+bool Connection::isConnected() const
+{
+    return m_callback && !m_callback->isDisconnected();
+}
+
+void Connection::disconnect()
+{
+    // A destroyed signal marks all its callbacks as disconnected, and we hold a reference on ours,
+    // so m_signal is only used while it is alive
+    if (!isConnected()) {
+        return;
+    }
+    SignalResource *const receiver = m_callback->m_receiver;
+    if (m_signal->removeConnection(m_callback) && receiver) {
+        SignalBase::notifyReceiverDisconnection(receiver, m_signal);
+    }
+}
+
+void Connection::setPriority(iint32 priority)
+{
+    if (!isConnected()) {
+        return;
+    }
+    m_signal->setPriority(m_callback, priority);
+}
+
+iint32 Connection::priority() const
+{
+    return m_callback ? m_callback->priority() : 0;
+}
+
+bool Connection::operator==(const Connection &connection) const
+{
+    return m_callback == connection.m_callback;
+}
+
+bool Connection::operator!=(const Connection &connection) const
+{
+    return m_callback != connection.m_callback;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ScopedConnection::ScopedConnection()
+{
+}
+
+ScopedConnection::ScopedConnection(const Connection &connection)
+    : m_connection(connection)
+{
+}
+
+ScopedConnection::~ScopedConnection()
+{
+    m_connection.disconnect();
+}
+
+ScopedConnection &ScopedConnection::operator=(const Connection &connection)
+{
+    if (connection != m_connection) {
+        m_connection.disconnect();
+        m_connection = connection;
+    }
+    return *this;
+}
+
+bool ScopedConnection::isConnected() const
+{
+    return m_connection.isConnected();
+}
+
+void ScopedConnection::disconnect()
+{
+    m_connection.disconnect();
+}
+
+Connection ScopedConnection::release()
+{
+    const Connection res = m_connection;
+    m_connection = Connection();
+    return res;
+}
+
+const Connection &ScopedConnection::connection() const
+{
+    return m_connection;
+}
+
+}
@@ -0,0 +1,154 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include <ideal_export.h>
+
+namespace IdealCore {
+
+class CallbackDummy;
+class SignalBase;
+
+/**
+  * @class Connection connection.h core/connection.h
+  *
+  * A handle to a connection made with one of the connect methods of a signal. Disconnecting through
+  * the handle takes constant time, regardless of the number of connections the signal has:
+  *
+  * @code
+  * Connection connection = myObject->valueChanged.connect(this, &MyClass::updateValue);
+  * ...
+  * connection.disconnect();
+  * @endcode
+  *
+  * Handles can be copied freely, and all copies refer to the same connection. Destroying a handle
+  * does not disconnect; see ScopedConnection for that.
+  *
+  * @note A handle stays valid after its signal is destroyed: it is then reported as disconnected.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT Connection
+{
+    template <typename... Param>
+    friend class Signal;
+
+public:
+    /**
+      * Creates a handle that does not refer to any connection.
+      */
+    Connection();
+    Connection(const Connection &connection);
+    ~Connection();
+
+    Connection &operator=(const Connection &connection);
+
+    /**
+      * @return Whether the connection still exists.
+      */
+    bool isConnected() const;
+
+    /**
+      * Disconnects the connection. Nothing is done if it was already disconnected.
+      *
+      * @note The signal must not be being destroyed concurrently from another thread.
+      */
+    void disconnect();
+
+    /**
+      * Sets the priority of the connection. Slots with higher priority are called first, and slots
+      * with the same priority are called in the order they were connected. By default the
+      * priority is 0.
+      *
+      * @note The signal must not be being destroyed concurrently from another thread.
+      */
+    void setPriority(iint32 priority);
+
+    /**
+      * @return The priority of the connection.
+      */
+    iint32 priority() const;
+
+    bool operator==(const Connection &connection) const;
+    bool operator!=(const Connection &connection) const;
+
+private:
+    Connection(const SignalBase *signal, CallbackDummy *callback);
+
+    const SignalBase *m_signal;
+    CallbackDummy    *m_callback;
+};
+
+/**
+  * @class ScopedConnection connection.h core/connection.h
+  *
+  * A connection that is disconnected when the ScopedConnection is destroyed, or when a different
+  * connection is assigned to it.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT ScopedConnection
+{
+public:
+    ScopedConnection();
+    ScopedConnection(const Connection &connection);
+
+    /**
+      * Disconnects the connection.
+      */
+    ~ScopedConnection();
+
+    /**
+      * Disconnects the current connection and takes ownership of @p connection.
+      */
+    ScopedConnection &operator=(const Connection &connection);
+
+    /**
+      * @return Whether the connection still exists.
+      */
+    bool isConnected() const;
+
+    /**
+      * Disconnects the connection.
+      */
+    void disconnect();
+
+    /**
+      * @return The connection, which will not be disconnected anymore when this object is destroyed.
+      */
+    Connection release();
+
+    /**
+      * @return The connection, that is still owned by this object.
+      */
+    const Connection &connection() const;
+
+private:
+    ScopedConnection(const ScopedConnection &scopedConnection);
+    ScopedConnection &operator=(const ScopedConnection &scopedConnection);
+
+    Connection m_connection;
+};
+
+}
+
+#endif //CONNECTION_H
@@ -0,0 +1,56 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "delivery_policy.h"
+
+namespace IdealCore {
+
+DeliveryPolicy::DeliveryPolicy(Mode mode, iuint32 interval)
+    : m_mode(mode)
+    , m_interval(interval)
+{
+}
+
+DeliveryPolicy::Mode DeliveryPolicy::mode() const
+{
+    return m_mode;
+}
+
+iuint32 DeliveryPolicy::interval() const
+{
+    return m_interval;
+}
+
+DeliveryPolicy DeliveryPolicy::coalesced()
+{
+    return DeliveryPolicy(Coalesced);
+}
+
+DeliveryPolicy DeliveryPolicy::throttled(iuint32 interval)
+{
+    return DeliveryPolicy(Throttled, interval);
+}
+
+DeliveryPolicy DeliveryPolicy::debounced(iuint32 interval)
+{
+    return DeliveryPolicy(Debounced, interval);
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DELIVERY_POLICY_H
+#define DELIVERY_POLICY_H
+
+#include <ideal_export.h>
+
+namespace IdealCore {
+
+/**
+  * @class DeliveryPolicy delivery_policy.h core/delivery_policy.h
+  *
+  * How the emissions of a queued connection are delivered to its slot. With any mode other than
+  * Queued only the newest arguments are kept, and emissions that would be redundant are dropped
+  * before anything is posted to the event loop:
+  *
+  * @code
+  * progress.connectQueued(progressBar, &ProgressBar::setValue, eventLoop,
+  *                        DeliveryPolicy::throttled(40));
+  * @endcode
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT DeliveryPolicy
+{
+public:
+    enum Mode {
+        Queued = 0, ///< Every emission is delivered.
+        Coalesced,  ///< Emissions not delivered yet are replaced by the newest one.
+        Throttled,  ///< As Coalesced, and deliveries are at least interval() milliseconds apart.
+        Debounced   ///< As Coalesced, and delivered once there were no emissions for interval() milliseconds.
+    };
+
+    DeliveryPolicy(Mode mode = Queued, iuint32 interval = 0);
+
+    Mode mode() const;
+
+    /**
+      * @return The interval in milliseconds used by Throttled and Debounced.
+      */
+    iuint32 interval() const;
+
+    static DeliveryPolicy coalesced();
+    static DeliveryPolicy throttled(iuint32 interval);
+    static DeliveryPolicy debounced(iuint32 interval);
+
+private:
+    Mode    m_mode;
+    iuint32 m_interval;
+};
+
+}
+
+#endif //DELIVERY_POLICY_H
@@ -0,0 +1,245 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "epoch.h"
+
+#include <atomic>
+#include <thread>
+
+namespace IdealCore {
+
+/**
+  * @internal
+  *
+  * The state of a thread taking part in reclamation. Participants are never freed: when a thread
+  * finishes, its participant is left for the next thread to take, along with the objects it
+  * retired that were not destroyed yet.
+  */
+class Epoch::Participant
+{
+public:
+    struct Retired
+    {
+        void    *object;
+        Destroy  destroy;
+        iuint64  epoch;
+        Retired *next;
+    };
+
+    Participant();
+
+    /**
+      * @return The participant of the calling thread, which is taken the first time.
+      */
+    static Participant *current();
+
+    /**
+      * Advances the global epoch if all threads holding a Guard have seen the current one.
+      *
+      * @return Whether the global epoch was advanced, by this thread or another one.
+      */
+    static bool tryAdvance();
+
+    void collect();
+
+    static std::atomic<iuint64> &globalEpoch();
+    static std::atomic<Participant*> &firstParticipant();
+
+    /**
+      * Releases the participant of a thread when it finishes.
+      */
+    class Owner
+    {
+    public:
+        Owner()
+            : m_participant(0)
+        {
+        }
+
+        ~Owner()
+        {
+            if (m_participant) {
+                m_participant->collect();
+                m_participant->m_inUse.store(false, std::memory_order_release);
+            }
+        }
+
+        Participant *m_participant;
+    };
+
+    /**
+      * The epoch seen when the outermost Guard was taken, shifted left one bit, with the lowest bit
+      * set while a Guard is held.
+      */
+    std::atomic<iuint64>  m_state;
+    std::atomic<bool>     m_inUse;
+    size_t                m_nesting;
+    // Newest first, so their epochs are in non increasing order
+    Retired              *m_retired;
+    size_t                m_retiredCount;
+    Participant          *m_next;
+};
+
+/**
+  * @internal
+  *
+  * A thread collects every this many retired objects even if it holds a Guard.
+  */
+static const size_t collectThreshold = 64;
+
+Epoch::Participant::Participant()
+    : m_state(0)
+    , m_inUse(true)
+    , m_nesting(0)
+    , m_retired(0)
+    , m_retiredCount(0)
+    , m_next(0)
+{
+}
+
+Epoch::Participant *Epoch::Participant::current()
+{
+    static __thread Participant *currentParticipant = 0;
+    if (IDEAL_LIKELY(currentParticipant != 0)) {
+        return currentParticipant;
+    }
+    static thread_local Owner currentParticipantOwner;
+    for (Participant *participant = firstParticipant().load(std::memory_order_acquire); participant;
+         participant = participant->m_next) {
+        bool inUse = false;
+        if (!participant->m_inUse.load(std::memory_order_relaxed) &&
+            participant->m_inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire)) {
+            currentParticipant = participant;
+            break;
+        }
+    }
+    if (!currentParticipant) {
+        currentParticipant = new Participant;
+        Participant *next = firstParticipant().load(std::memory_order_relaxed);
+        do {
+            currentParticipant->m_next = next;
+        } while (!firstParticipant().compare_exchange_weak(next, currentParticipant, std::memory_order_release,
+                                                            std::memory_order_relaxed));
+    }
+    currentParticipantOwner.m_participant = currentParticipant;
+    return currentParticipant;
+}
+
+bool Epoch::Participant::tryAdvance()
+{
+    iuint64 epoch = globalEpoch().load(std::memory_order_seq_cst);
+    for (Participant *participant = firstParticipant().load(std::memory_order_acquire); participant;
+         participant = participant->m_next) {
+        const iuint64 state = participant->m_state.load(std::memory_order_seq_cst);
+        if ((state & 1) && (state >> 1) != epoch) {
+            return false;
+        }
+    }
+    globalEpoch().compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+    return true;
+}
+
+void Epoch::Participant::collect()
+{
+    // Objects retired at epoch e can be in use by threads that saw e - 1 or e, so they are
+    // destroyed once the global epoch reaches e + 2
+    if (tryAdvance()) {
+        tryAdvance();
+    }
+    const iuint64 epoch = globalEpoch().load(std::memory_order_seq_cst);
+    Retired **link = &m_retired;
+    while (*link && (*link)->epoch + 2 > epoch) {
+        link = &(*link)->next;
+    }
+    Retired *retired = *link;
+    *link = 0;
+    // Destroying can retire more objects, which are added to the list again
+    while (retired) {
+        Retired *const next = retired->next;
+        retired->destroy(retired->object);
+        delete retired;
+        --m_retiredCount;
+        retired = next;
+    }
+}
+
+std::atomic<iuint64> &Epoch::Participant::globalEpoch()
+{
+    static std::atomic<iuint64> epoch(0);
+    return epoch;
+}
+
+std::atomic<Epoch::Participant*> &Epoch::Participant::firstParticipant()
+{
+    static std::atomic<Participant*> participant(0);
+    return participant;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Epoch::Guard::Guard()
+    : m_participant(Participant::current())
+{
+    if (!m_participant->m_nesting++) {
+        const iuint64 epoch = Participant::globalEpoch().load(std::memory_order_relaxed);
+        m_participant->m_state.store((epoch << 1) | 1, std::memory_order_seq_cst);
+    }
+}
+
+Epoch::Guard::~Guard()
+{
+    if (!--m_participant->m_nesting) {
+        m_participant->m_state.store(0, std::memory_order_release);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Epoch::retire(void *object, Destroy destroy)
+{
+    Participant *const participant = Participant::current();
+    Participant::Retired *const retired = new Participant::Retired;
+    retired->object = object;
+    retired->destroy = destroy;
+    retired->epoch = Participant::globalEpoch().load(std::memory_order_seq_cst);
+    retired->next = participant->m_retired;
+    participant->m_retired = retired;
+    ++participant->m_retiredCount;
+    if (!participant->m_nesting || participant->m_retiredCount >= collectThreshold) {
+        participant->collect();
+    }
+}
+
+void Epoch::collect()
+{
+    Participant::current()->collect();
+}
+
+void Epoch::synchronize()
+{
+    Participant *const participant = Participant::current();
+    participant->collect();
+    while (participant->m_retired) {
+        std::this_thread::yield();
+        participant->collect();
+    }
+}
+
+}
@@ -0,0 +1,103 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <ideal_export.h>
+
+namespace IdealCore {
+
+/**
+  * @class Epoch epoch.h core/epoch.h
+  *
+  * Epoch based reclamation, so lock-free structures can free what they unlink while other threads
+  * may still be reading it. Readers hold a Guard while they use pointers loaded from the structure.
+  * Writers unlink an object and then retire() it. It is destroyed once every thread that held a
+  * Guard when it was retired has released it:
+  *
+  * @code
+  * {
+  *     Epoch::Guard guard;
+  *     Node *const node = m_head.load();
+  *     ...
+  * }
+  *
+  * Node *const oldHead = m_head.exchange(newHead);
+  * Epoch::retire(oldHead, &Node::destroy);
+  * @endcode
+  *
+  * Holding a Guard costs a store to a word owned by the calling thread on entry and on exit.
+  * Objects are destroyed from the thread that retired them, by later calls to retire() or
+  * collect(). Retiring while no Guard is held collects at once, so without concurrent readers an
+  * object is destroyed before retire() returns.
+  *
+  * @note A thread holding a Guard for a long time delays the destruction of everything retired
+  *       meanwhile, but never blocks other threads.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT Epoch
+{
+    class Participant;
+
+public:
+    typedef void (*Destroy)(void *object);
+
+    /**
+      * @class Guard epoch.h core/epoch.h
+      *
+      * While a Guard exists, objects retired by any thread are not destroyed. Guards can be nested.
+      */
+    class IDEAL_EXPORT Guard
+    {
+    public:
+        Guard();
+        ~Guard();
+
+    private:
+        Guard(const Guard &guard);
+        Guard &operator=(const Guard &guard);
+
+        Participant *const m_participant;
+    };
+
+    /**
+      * Calls @p destroy with @p object once no thread can be using it. @p object has to be
+      * unreachable for threads that take a Guard from now on.
+      */
+    static void retire(void *object, Destroy destroy);
+
+    /**
+      * Destroys the objects retired by the calling thread that can no longer be in use.
+      */
+    static void collect();
+
+    /**
+      * Waits until all objects retired by the calling thread have been destroyed.
+      *
+      * @note Must not be called while the calling thread holds a Guard.
+      */
+    static void synchronize();
+};
+
+}
+
+#endif //EPOCH_H
@@ -0,0 +1,353 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "event_loop.h"
+#include "private/event_loop_p.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+namespace IdealCore {
+
+EventLoop::Private::Private(EventLoop *q)
+    : q(q)
+    , m_events(0)
+    , m_quit(false)
+    , m_running(false)
+    , m_returnCode(0)
+    , m_timers(0)
+    , m_timerCount(0)
+    , m_timerCapacity(0)
+    , m_nextTimerId(1)
+{
+}
+
+EventLoop::Private::~Private()
+{
+    Event *event = m_events.exchange(0, std::memory_order_acquire);
+    while (event) {
+        Event *const next = event->m_next;
+        delete event;
+        event = next;
+    }
+    for (size_t i = 0; i < m_timerCount; ++i) {
+        delete m_timers[i].event;
+    }
+    free(m_timers);
+}
+
+EventLoop::Event *EventLoop::Private::takeEvents()
+{
+    // Events are pushed at the head, so the list is reversed to get them in the order they came
+    Event *event = m_events.exchange(0, std::memory_order_acquire);
+    Event *res = 0;
+    while (event) {
+        Event *const next = event->m_next;
+        event->m_next = res;
+        res = event;
+        event = next;
+    }
+    return res;
+}
+
+size_t EventLoop::Private::executeEvents()
+{
+    size_t res = 0;
+    Event *event = takeEvents();
+    while (event) {
+        Event *const next = event->m_next;
+        event->execute();
+        delete event;
+        event = next;
+        ++res;
+    }
+    return res;
+}
+
+size_t EventLoop::Private::dispatchTimers()
+{
+    size_t res = 0;
+    const iuint64 now = EventLoop::currentTime();
+    // Timers restarted while dispatching expire in the future, so this loop always ends
+    while (m_timerCount && m_timers[0].deadline <= now) {
+        Timer timer = m_timers[0];
+        popTimer();
+        if (timer.event) {
+            timer.event->execute();
+            delete timer.event;
+            ++res;
+            continue;
+        }
+        // Repeating timers are scheduled again before timeout is emitted, so they can be stopped
+        // from the slot
+        if (!timer.singleShot) {
+            timer.deadline += timer.interval;
+            if (timer.deadline <= now) {
+                timer.deadline = now + timer.interval;
+            }
+            pushTimer(timer);
+        }
+        q->timeout.emit(timer.id);
+        ++res;
+    }
+    return res;
+}
+
+void EventLoop::Private::pushTimer(const Timer &timer)
+{
+    if (m_timerCount == m_timerCapacity) {
+        m_timerCapacity = m_timerCapacity ? m_timerCapacity * 2 : 4;
+        m_timers = (Timer*) realloc(m_timers, m_timerCapacity * sizeof(Timer));
+    }
+    // Binary min-heap on the deadline
+    size_t i = m_timerCount++;
+    while (i) {
+        const size_t parent = (i - 1) / 2;
+        if (m_timers[parent].deadline <= timer.deadline) {
+            break;
+        }
+        m_timers[i] = m_timers[parent];
+        i = parent;
+    }
+    m_timers[i] = timer;
+}
+
+void EventLoop::Private::popTimer()
+{
+    const Timer last = m_timers[--m_timerCount];
+    size_t i = 0;
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= m_timerCount) {
+            break;
+        }
+        if (child + 1 < m_timerCount && m_timers[child + 1].deadline < m_timers[child].deadline) {
+            ++child;
+        }
+        if (last.deadline <= m_timers[child].deadline) {
+            break;
+        }
+        m_timers[i] = m_timers[child];
+        i = child;
+    }
+    if (m_timerCount) {
+        m_timers[i] = last;
+    }
+}
+
+size_t EventLoop::Private::iterate(iint32 timeout)
+{
+    // Resources deleted with deleteLater() while dispatching are deleted once each step is done,
+    // and not while waiting
+    size_t res;
+    {
+        SignalResource::DeferredDeletionScope deferredDeletionScope;
+        res = executeEvents();
+    }
+    if (res || m_quit.load(std::memory_order_acquire)) {
+        timeout = 0;
+    }
+    if (m_timerCount && timeout) {
+        const iuint64 now = EventLoop::currentTime();
+        const iuint64 deadline = m_timers[0].deadline;
+        const iint32 timerTimeout = deadline > now ? (iint32) (deadline - now) : 0;
+        if (timeout == -1 || timerTimeout < timeout) {
+            timeout = timerTimeout;
+        }
+    }
+    ReadyFileDescriptor ready[readyBatchSize];
+    const size_t readyCount = static_cast<PrivateImpl*>(this)->waitForEvents(timeout, ready);
+    SignalResource::DeferredDeletionScope deferredDeletionScope;
+    for (size_t i = 0; i < readyCount; ++i) {
+        if (ready[i].events & Read) {
+            q->readyRead.emit(ready[i].fileDescriptor);
+        }
+        if (ready[i].events & Write) {
+            q->readyWrite.emit(ready[i].fileDescriptor);
+        }
+    }
+    res += readyCount;
+    if (m_timerCount) {
+        res += dispatchTimers();
+    }
+    return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+EventLoop::Event::Event()
+    : m_next(0)
+{
+}
+
+EventLoop::Event::~Event()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * Posted by postDelayed(), so the delayed event is added to the timers from the thread running the
+  * loop.
+  */
+class EventLoop::Private::DelayedEvent
+    : public EventLoop::Event
+{
+public:
+    DelayedEvent(Private *eventLoop, Event *event, iuint64 deadline)
+        : m_eventLoop(eventLoop)
+        , m_event(event)
+        , m_deadline(deadline)
+    {
+    }
+
+    virtual ~DelayedEvent()
+    {
+        delete m_event;
+    }
+
+    virtual void execute()
+    {
+        Timer timer;
+        timer.deadline = m_deadline;
+        timer.id = 0;
+        timer.interval = 0;
+        timer.singleShot = true;
+        timer.event = m_event;
+        m_eventLoop->pushTimer(timer);
+        m_event = 0;
+    }
+
+    Private *const   m_eventLoop;
+    Event           *m_event;
+    const iuint64    m_deadline;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+EventLoop::EventLoop()
+    : IDEAL_SIGNAL_INIT(readyRead, iint32)
+    , IDEAL_SIGNAL_INIT(readyWrite, iint32)
+    , IDEAL_SIGNAL_INIT(timeout, iuint64)
+    , d(new PrivateImpl(this))
+{
+}
+
+EventLoop::~EventLoop()
+{
+    delete d;
+}
+
+void EventLoop::post(Event *event)
+{
+    Event *head = d->m_events.load(std::memory_order_relaxed);
+    do {
+        event->m_next = head;
+    } while (!d->m_events.compare_exchange_weak(head, event, std::memory_order_release,
+                                                std::memory_order_relaxed));
+    // Only the post that finds the queue empty needs to wake up the loop: the loop takes the queue
+    // after it wakes up, so the events that follow are taken too
+    if (!head) {
+        D_I->wakeUp();
+    }
+}
+
+void EventLoop::postDelayed(Event *event, iuint32 delay)
+{
+    post(new Private::DelayedEvent(d, event, currentTime() + delay));
+}
+
+void EventLoop::watch(iint32 fileDescriptor, iuint32 events)
+{
+    D_I->watch(fileDescriptor, events);
+}
+
+void EventLoop::unwatch(iint32 fileDescriptor)
+{
+    D_I->unwatch(fileDescriptor);
+}
+
+iuint64 EventLoop::startTimer(iuint32 interval, bool singleShot)
+{
+    Private::Timer timer;
+    timer.deadline = currentTime() + interval;
+    timer.id = d->m_nextTimerId++;
+    timer.interval = interval ? interval : 1;
+    timer.singleShot = singleShot;
+    timer.event = 0;
+    d->pushTimer(timer);
+    return timer.id;
+}
+
+void EventLoop::stopTimer(iuint64 timerId)
+{
+    for (size_t i = 0; i < d->m_timerCount; ++i) {
+        if (d->m_timers[i].id == timerId) {
+            // Move the timer to the top of the heap and pop it
+            Private::Timer timer = d->m_timers[i];
+            while (i) {
+                const size_t parent = (i - 1) / 2;
+                d->m_timers[i] = d->m_timers[parent];
+                i = parent;
+            }
+            d->m_timers[0] = timer;
+            d->popTimer();
+            return;
+        }
+    }
+}
+
+size_t EventLoop::processEvents()
+{
+    return d->iterate(0);
+}
+
+iint32 EventLoop::exec()
+{
+    d->m_running.store(true, std::memory_order_release);
+    while (!d->m_quit.exchange(false, std::memory_order_acq_rel)) {
+        d->iterate(-1);
+    }
+    d->m_running.store(false, std::memory_order_release);
+    return d->m_returnCode;
+}
+
+void EventLoop::quit(iint32 returnCode)
+{
+    d->m_returnCode = returnCode;
+    d->m_quit.store(true, std::memory_order_release);
+    D_I->wakeUp();
+}
+
+bool EventLoop::isRunning() const
+{
+    return d->m_running.load(std::memory_order_acquire);
+}
+
+iuint64 EventLoop::currentTime()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (iuint64) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+}
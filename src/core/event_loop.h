@@ -0,0 +1,405 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <ideal_export.h>
+#include <core/ideal_signal.h>
+#include <core/signal_resource.h>
+
+namespace IdealCore {
+
+/**
+  * @class EventLoop event_loop.h core/event_loop.h
+  *
+  * An event loop runs on one thread and dispatches:
+  *
+  *     - Events and callbacks posted to it, from that or from any other thread.
+  *     - Emissions of queued signal connections, so the slot runs on the thread of the loop
+  *       instead of on the emitting one.
+  *     - Readiness of watched file descriptors, through readyRead and readyWrite.
+  *     - Timers, through timeout.
+  *
+  * @code
+  * EventLoop eventLoop;
+  * eventLoop.readyRead.connect(this, &MyClass::readData);
+  * eventLoop.watch(socket, EventLoop::Read);
+  * myObject->valueChanged.connectQueued(this, &MyClass::updateValue, eventLoop);
+  * eventLoop.exec();
+  * @endcode
+  *
+  * Posting never blocks and never takes a lock: events are pushed to a lock-free queue that the
+  * loop takes at once, so all events posted since the last time it looked are executed as one
+  * batch, in the same order they were posted by each thread. Ready file descriptors are also
+  * collected and dispatched in batches.
+  *
+  * @note On Linux file descriptors are watched with epoll, and on other systems with poll.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT EventLoop
+    : public SignalResource
+{
+public:
+    /**
+      * @class Event event_loop.h core/event_loop.h
+      *
+      * A unit of work posted to an event loop. The loop owns the events posted to it, and deletes
+      * them after they are executed, or when it is destroyed if they were not.
+      */
+    class IDEAL_EXPORT Event
+    {
+        friend class EventLoop;
+
+    public:
+        Event();
+        virtual ~Event();
+
+        /**
+          * Executed on the thread running the event loop.
+          */
+        virtual void execute() = 0;
+
+    private:
+        Event *m_next;
+    };
+
+    enum FileDescriptorEvent {
+        Read  = 1,  ///< The file descriptor has data to read, or it was closed.
+        Write = 2   ///< Data can be written to the file descriptor.
+    };
+
+    EventLoop();
+
+    /**
+      * Deletes the events that were not executed.
+      */
+    virtual ~EventLoop();
+
+    /**
+      * Posts @p event to this loop, which takes its ownership. Can be called from any thread, and
+      * it never blocks.
+      */
+    void post(Event *event);
+
+    /**
+      * Posts @p callback to this loop, which calls it with no arguments. Can be called from any
+      * thread, and it never blocks.
+      */
+    template <typename Callback>
+    void postCallback(Callback callback);
+
+    /**
+      * Posts @p event to be executed once @p delay milliseconds have passed. Can be called from any
+      * thread, and it never blocks.
+      */
+    void postDelayed(Event *event, iuint32 delay);
+
+    /**
+      * Starts watching @p fileDescriptor for @p events, an OR combination of FileDescriptorEvent.
+      * If it was already watched, only @p events are watched from now on.
+      *
+      * @note Only the thread running this loop can call this method, or any thread before it runs.
+      */
+    void watch(iint32 fileDescriptor, iuint32 events);
+
+    /**
+      * Stops watching @p fileDescriptor.
+      *
+      * @note Only the thread running this loop can call this method, or any thread before it runs.
+      */
+    void unwatch(iint32 fileDescriptor);
+
+    /**
+      * Starts a timer that expires after @p interval milliseconds, and every @p interval milliseconds
+      * after that unless @p singleShot is true.
+      *
+      * @return The identifier of the timer, given to timeout when it expires.
+      *
+      * @note Only the thread running this loop can call this method, or any thread before it runs.
+      */
+    iuint64 startTimer(iuint32 interval, bool singleShot = false);
+
+    /**
+      * Stops the timer @p timerId. Single shot timers are stopped after they expire.
+      *
+      * @note Only the thread running this loop can call this method, or any thread before it runs.
+      */
+    void stopTimer(iuint64 timerId);
+
+    /**
+      * Executes all events posted so far, dispatches file descriptors that are ready and timers that
+      * expired, without waiting for new ones.
+      *
+      * @return The number of events, file descriptors and timers dispatched.
+      *
+      * @note Only the thread running this loop can call this method.
+      */
+    size_t processEvents();
+
+    /**
+      * Runs this loop on the calling thread, until quit() is called.
+      *
+      * @return The code given to quit().
+      */
+    iint32 exec();
+
+    /**
+      * Makes exec() return @p returnCode once the events being executed are done. Can be called
+      * from any thread.
+      */
+    void quit(iint32 returnCode = 0);
+
+    /**
+      * @return Whether exec() is running.
+      */
+    bool isRunning() const;
+
+    /**
+      * @return The current time of the monotonic clock used by timers, in milliseconds.
+      */
+    static iuint64 currentTime();
+
+    /**
+      * A watched file descriptor is ready for reading.
+      */
+    IDEAL_SIGNAL(readyRead, iint32);
+
+    /**
+      * A watched file descriptor is ready for writing.
+      */
+    IDEAL_SIGNAL(readyWrite, iint32);
+
+    /**
+      * The timer with the given identifier expired.
+      */
+    IDEAL_SIGNAL(timeout, iuint64);
+
+private:
+    EventLoop(const EventLoop &eventLoop);
+    EventLoop &operator=(const EventLoop &eventLoop);
+
+    class Private;
+    class PrivateImpl;
+    Private *d;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  */
+template <typename Callback>
+class CallbackEvent
+    : public EventLoop::Event
+{
+public:
+    CallbackEvent(const Callback &callback)
+        : m_callback(callback)
+    {
+    }
+
+    virtual void execute()
+    {
+        m_callback();
+    }
+
+    Callback m_callback;
+};
+
+template <typename Callback>
+void EventLoop::postCallback(Callback callback)
+{
+    post(new CallbackEvent<Callback>(callback));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * Delivers emissions through an event loop, where the slot is called. Emitting never blocks on the
+  * receiver. Whether the connection still exists and whether the receiver blocks signals is checked
+  * when the slot is about to be called.
+  *
+  * With the Queued policy each emission posts its own event. With the others, the newest
+  * arguments are kept in m_pending and only the emission that finds it empty posts an event, so
+  * there is at most one delivery scheduled at any time.
+  */
+template <typename Receiver, typename Member, typename... Param>
+class CallbackQueued
+    : public CallbackBase<Param...>
+{
+public:
+    typedef std::tuple<Param...> Arguments;
+
+    CallbackQueued(Receiver *receiver, Member member, EventLoop &eventLoop, const DeliveryPolicy &deliveryPolicy,
+                   const ichar *signalName)
+        : m_member(member)
+        , m_eventLoop(eventLoop)
+        , m_deliveryPolicy(deliveryPolicy)
+        , m_pending(0)
+        , m_lastEmission(0)
+        , m_lastDelivery(0)
+        , m_signalName(signalName)
+    {
+        this->m_receiver = receiver;
+    }
+
+    virtual ~CallbackQueued()
+    {
+        delete m_pending.load(std::memory_order_relaxed);
+    }
+
+    class QueuedCall
+        : public EventLoop::Event
+    {
+    public:
+        QueuedCall(CallbackQueued *callback, const Param&... param)
+            : m_callback(callback)
+            , m_arguments(param...)
+        {
+            m_callback->ref();
+        }
+
+        virtual ~QueuedCall()
+        {
+            m_callback->deref();
+        }
+
+        virtual void execute()
+        {
+            m_callback->call(m_arguments);
+        }
+
+        CallbackQueued *m_callback;
+        Arguments       m_arguments;
+    };
+
+    class PendingCall
+        : public EventLoop::Event
+    {
+    public:
+        PendingCall(CallbackQueued *callback)
+            : m_callback(callback)
+        {
+            m_callback->ref();
+        }
+
+        virtual ~PendingCall()
+        {
+            m_callback->deref();
+        }
+
+        virtual void execute()
+        {
+            m_callback->deliverPending();
+        }
+
+        CallbackQueued *m_callback;
+    };
+
+    virtual void operator()(const Param&... param)
+    {
+        if (m_deliveryPolicy.mode() == DeliveryPolicy::Queued) {
+            m_eventLoop.post(new QueuedCall(this, param...));
+            return;
+        }
+        if (m_deliveryPolicy.mode() == DeliveryPolicy::Debounced) {
+            m_lastEmission.store(EventLoop::currentTime(), std::memory_order_relaxed);
+        }
+        Arguments *const previous = m_pending.exchange(new Arguments(param...), std::memory_order_acq_rel);
+        if (previous) {
+            // A delivery is already scheduled, and it will take the newest arguments
+            delete previous;
+            return;
+        }
+        m_eventLoop.post(new PendingCall(this));
+    }
+
+    /**
+      * Called on the thread running the event loop.
+      */
+    void deliverPending()
+    {
+        if (!this->isDisconnected() && m_deliveryPolicy.mode() != DeliveryPolicy::Coalesced) {
+            const iuint64 now = EventLoop::currentTime();
+            const iuint64 due = m_deliveryPolicy.interval() +
+                                (m_deliveryPolicy.mode() == DeliveryPolicy::Throttled ? m_lastDelivery
+                                                                                      : m_lastEmission.load(std::memory_order_relaxed));
+            if (now < due) {
+                m_eventLoop.postDelayed(new PendingCall(this), due - now);
+                return;
+            }
+            m_lastDelivery = now;
+        }
+        Arguments *const arguments = m_pending.exchange(0, std::memory_order_acq_rel);
+        if (arguments) {
+            call(*arguments);
+            delete arguments;
+        }
+    }
+
+    void call(const Arguments &arguments)
+    {
+        if (this->isDisconnected() || this->m_receiver->areSignalsBlocked()) {
+            return;
+        }
+        if (IDEAL_UNLIKELY(SignalTrace::isEnabled())) {
+            const iuint64 callStart = SignalTrace::now();
+            call(arguments, typename MakeIndexList<sizeof...(Param)>::Type());
+            SignalTrace::record(SignalTrace::QueuedCall, m_signalName, this->m_receiver, callStart);
+            return;
+        }
+        call(arguments, typename MakeIndexList<sizeof...(Param)>::Type());
+    }
+
+    template <size_t... Index>
+    void call(const Arguments &arguments, IndexList<Index...>)
+    {
+        (static_cast<Receiver*>(this->m_receiver)->*m_member)(std::get<Index>(arguments)...);
+    }
+
+    Member                  m_member;
+    EventLoop              &m_eventLoop;
+    const DeliveryPolicy    m_deliveryPolicy;
+    std::atomic<Arguments*> m_pending;
+    std::atomic<iuint64>    m_lastEmission;
+    iuint64                 m_lastDelivery;
+    const ichar            *m_signalName;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  */
+template <typename... Param>
+template <typename Receiver, typename Member>
+CallbackBase<Param...> *CallbackBase<Param...>::makeQueued(Receiver *receiver, Member member, EventLoop &eventLoop,
+                                                          const DeliveryPolicy &deliveryPolicy, const ichar *signalName)
+{
+    return new CallbackQueued<Receiver, Member, Param...>(receiver, member, eventLoop, deliveryPolicy, signalName);
+}
+
+}
+
+#endif //EVENT_LOOP_H
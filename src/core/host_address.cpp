@@ -0,0 +1,201 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "host_address.h"
+#include "uri.h"
+
+#include <string.h>
+
+namespace IdealCore {
+
+static const iuint8 ipv4MappedPrefix[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+
+static const ichar address_hex[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
+                                     'a', 'b', 'c', 'd', 'e', 'f' };
+
+HostAddress::HostAddress()
+    : m_protocol(NoProtocol)
+{
+    memset(m_address, 0, sizeof(m_address));
+}
+
+HostAddress::HostAddress(iuint32 ipv4)
+    : m_protocol(IPv4)
+{
+    memcpy(m_address, ipv4MappedPrefix, sizeof(ipv4MappedPrefix));
+    m_address[12] = (ipv4 >> 24) & 0xff;
+    m_address[13] = (ipv4 >> 16) & 0xff;
+    m_address[14] = (ipv4 >> 8) & 0xff;
+    m_address[15] = ipv4 & 0xff;
+}
+
+HostAddress::HostAddress(const iuint8 *ipv6)
+    : m_protocol(IPv6)
+{
+    memcpy(m_address, ipv6, sizeof(m_address));
+}
+
+HostAddress::Protocol HostAddress::protocol() const
+{
+    return m_protocol;
+}
+
+bool HostAddress::isNull() const
+{
+    return m_protocol == NoProtocol;
+}
+
+iuint32 HostAddress::toIPv4() const
+{
+    if (m_protocol != IPv4) {
+        return 0;
+    }
+    return (m_address[12] << 24) | (m_address[13] << 16) | (m_address[14] << 8) | m_address[15];
+}
+
+const iuint8 *HostAddress::toIPv6() const
+{
+    return m_address;
+}
+
+String HostAddress::toString() const
+{
+    if (m_protocol == NoProtocol) {
+        return String();
+    }
+    // "ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255" is the longest output we can produce
+    ichar res[46];
+    ichar *p = res;
+    if (m_protocol == IPv6) {
+        iuint16 groups[8];
+        for (size_t i = 0; i < 8; ++i) {
+            groups[i] = (m_address[i * 2] << 8) | m_address[i * 2 + 1];
+        }
+        // IPv4-mapped addresses keep the IPv4 part in dotted decimal notation (RFC 5952, 5)
+        const bool ipv4Mapped = !memcmp(m_address, ipv4MappedPrefix, sizeof(ipv4MappedPrefix));
+        const size_t numGroups = ipv4Mapped ? 6 : 8;
+        // Find the longest run of zero groups. A single zero group is never compressed.
+        size_t bestStart = numGroups;
+        size_t bestLen = 1;
+        for (size_t i = 0; i < numGroups;) {
+            if (groups[i]) {
+                ++i;
+                continue;
+            }
+            size_t j = i;
+            while (j < numGroups && !groups[j]) {
+                ++j;
+            }
+            if (j - i > bestLen) {
+                bestStart = i;
+                bestLen = j - i;
+            }
+            i = j;
+        }
+        for (size_t i = 0; i < numGroups; ++i) {
+            if (i == bestStart) {
+                *p++ = ':';
+                *p++ = ':';
+                i += bestLen - 1;
+                continue;
+            }
+            if (i && i != bestStart + bestLen) {
+                *p++ = ':';
+            }
+            const iuint16 group = groups[i];
+            bool significant = false;
+            for (iint32 shift = 12; shift >= 0; shift -= 4) {
+                const iuint32 nibble = (group >> shift) & 0xf;
+                if (nibble || significant || !shift) {
+                    *p++ = address_hex[nibble];
+                    significant = true;
+                }
+            }
+        }
+        if (!ipv4Mapped) {
+            *p = '\0';
+            return String(res);
+        }
+        *p++ = ':';
+    }
+    for (size_t i = 12; i < 16; ++i) {
+        if (i != 12) {
+            *p++ = '.';
+        }
+        const iuint8 octet = m_address[i];
+        if (octet >= 100) {
+            *p++ = '0' + octet / 100;
+        }
+        if (octet >= 10) {
+            *p++ = '0' + (octet / 10) % 10;
+        }
+        *p++ = '0' + octet % 10;
+    }
+    *p = '\0';
+    return String(res);
+}
+
+HostAddress HostAddress::fromString(const String &address)
+{
+    if (address.empty()) {
+        return HostAddress();
+    }
+    String authority("//");
+    if (address.contains(':') && address[0] != '[') {
+        authority += '[';
+        authority += address;
+        authority += ']';
+    } else {
+        authority += address;
+    }
+    const Uri uri(authority);
+    if (!uri.isValid() || !uri.path().empty() || uri.port() != -1 || !uri.userInfo().empty()) {
+        return HostAddress();
+    }
+    return uri.hostAddress();
+}
+
+bool HostAddress::operator==(const HostAddress &address) const
+{
+    return isNull() == address.isNull() && !memcmp(m_address, address.m_address, sizeof(m_address));
+}
+
+bool HostAddress::operator!=(const HostAddress &address) const
+{
+    return !(*this == address);
+}
+
+bool HostAddress::operator<(const HostAddress &address) const
+{
+    if (isNull() != address.isNull()) {
+        return isNull();
+    }
+    return memcmp(m_address, address.m_address, sizeof(m_address)) < 0;
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::ostream &operator<<(std::ostream &stream, const IdealCore::HostAddress &address)
+{
+    stream << address.toString();
+    return stream;
+}
@@ -0,0 +1,124 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef HOST_ADDRESS_H
+#define HOST_ADDRESS_H
+
+#include <ideal_export.h>
+#include <core/ideal_string.h>
+
+namespace IdealCore {
+
+/**
+  * @class HostAddress host_address.h core/host_address.h
+  *
+  * This class represents an IPv4 or IPv6 address in binary form. It is what Uri::hostAddress()
+  * returns when the host of a URI is an IP address, so it can be compared without having to parse
+  * the host again:
+  *
+  * @code
+  * Uri uri("http://[2001:db8::1]:8080/");
+  * if (uri.hostAddress() == allowedAddress) {
+  *     // ...
+  * }
+  * @endcode
+  *
+  * Both kind of addresses are kept in 16 bytes. IPv4 addresses are stored as IPv4-mapped IPv6
+  * addresses (::ffff:a.b.c.d), so comparing two addresses is always a 16 byte comparison. This also
+  * means that an IPv4 address and its IPv4-mapped IPv6 form are equal.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT HostAddress
+{
+public:
+    enum Protocol {
+        NoProtocol = 0, ///< This address is null.
+        IPv4,           ///< This is an IPv4 address.
+        IPv6            ///< This is an IPv6 address.
+    };
+
+    /**
+      * Creates a null address.
+      */
+    HostAddress();
+
+    /**
+      * Creates an IPv4 address from @p ipv4, in host byte order (e.g. 0x7f000001 for 127.0.0.1).
+      */
+    HostAddress(iuint32 ipv4);
+
+    /**
+      * Creates an IPv6 address from the 16 bytes pointed by @p ipv6, in network byte order.
+      */
+    HostAddress(const iuint8 *ipv6);
+
+    /**
+      * @return The protocol of this address. NoProtocol if this address is null.
+      */
+    Protocol protocol() const;
+
+    /**
+      * @return Whether this address is null.
+      */
+    bool isNull() const;
+
+    /**
+      * @return The IPv4 address in host byte order. 0 if this is not an IPv4 address.
+      */
+    iuint32 toIPv4() const;
+
+    /**
+      * @return The 16 bytes of the address in network byte order. IPv4 addresses are returned
+      *         as IPv4-mapped IPv6 addresses.
+      */
+    const iuint8 *toIPv6() const;
+
+    /**
+      * @return The canonical text representation of this address. IPv4 addresses are printed in
+      *         dotted decimal notation, and IPv6 addresses as recommended by RFC 5952 (lowercase,
+      *         no leading zeros and the longest run of zero groups compressed). An empty string is
+      *         returned for a null address.
+      */
+    String toString() const;
+
+    /**
+      * @return The address represented by @p address, which can be written in IPv4 dotted decimal
+      *         notation or as an IPv6 address, with or without brackets. A null address is returned
+      *         if @p address is not a valid IP address.
+      */
+    static HostAddress fromString(const String &address);
+
+    bool operator==(const HostAddress &address) const;
+    bool operator!=(const HostAddress &address) const;
+    bool operator<(const HostAddress &address) const;
+
+private:
+    iuint8   m_address[16];
+    Protocol m_protocol;
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+IDEAL_EXPORT std::ostream &operator<<(std::ostream &stream, const IdealCore::HostAddress &address);
+
+#endif //HOST_ADDRESS_H
@@ -0,0 +1,710 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "ideal_signal.h"
+#include "thread_pool.h"
+#include "cond_var.h"
+#include "context_mutex_locker.h"
+
+#include <stdlib.h>
+
+#include <new>
+
+namespace IdealCore {
+
+ConnectionList *ConnectionList::make(size_t count, ThreadPool *threadPool)
+{
+    const size_t size = sizeof(ConnectionList) + (count ? count - 1 : 0) * sizeof(CallbackDummy*);
+    ConnectionList *const res = (ConnectionList*) malloc(size);
+    res->m_count = count;
+    new (&res->m_disconnectedCount) std::atomic<size_t>(0);
+    res->m_threadPool = threadPool;
+    res->m_staticSlots = 0;
+    res->m_hasForwards = false;
+    new (&res->m_refs) std::atomic<size_t>(1);
+    res->m_links = 0;
+    res->m_linkCount = 0;
+    new (&res->m_flattened) std::atomic<ConnectionList*>(0);
+    return res;
+}
+
+ConnectionList *ConnectionList::copy(const ConnectionList *connectionList, size_t extra, ThreadPool *threadPool, size_t &copied)
+{
+    const size_t oldCount = connectionList ? connectionList->m_count : 0;
+    ConnectionList *const res = make(oldCount + extra, threadPool);
+    if (connectionList && connectionList->m_staticSlots) {
+        res->m_staticSlots = connectionList->m_staticSlots;
+        res->m_staticSlots->ref();
+    }
+    copied = 0;
+    for (size_t i = 0; i < oldCount; ++i) {
+        CallbackDummy *const curr = connectionList->m_callbacks[i];
+        if (curr->isDisconnected()) {
+            continue;
+        }
+        curr->ref();
+        res->m_callbacks[copied++] = curr;
+        if (curr->forwardedSignal()) {
+            res->m_hasForwards = true;
+        }
+    }
+    // Callbacks disconnected while copying are skipped by emissions until the next copy
+    res->m_count = copied + extra;
+    return res;
+}
+
+void ConnectionList::destroy(ConnectionList *connectionList)
+{
+    ConnectionList *const flattened = connectionList->m_flattened.load(std::memory_order_acquire);
+    if (flattened) {
+        release(flattened);
+    }
+    for (size_t i = 0; i < connectionList->m_linkCount; ++i) {
+        const ForwardLink &link = connectionList->m_links[i];
+        link.forward->deref();
+        if (link.connections) {
+            release(link.connections);
+        }
+    }
+    free(connectionList->m_links);
+    discard(connectionList, connectionList->m_count);
+}
+
+void ConnectionList::release(ConnectionList *connectionList)
+{
+    if (connectionList->m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        destroy(connectionList);
+    }
+}
+
+void ConnectionList::discard(ConnectionList *connectionList, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        connectionList->m_callbacks[i]->deref();
+    }
+    if (connectionList->m_staticSlots) {
+        connectionList->m_staticSlots->deref();
+    }
+    free(connectionList);
+}
+
+static void releaseConnectionList(void *connectionList)
+{
+    ConnectionList *const res = static_cast<ConnectionList*>(connectionList);
+    // Only emissions of this list use its flattened list. Dropping it here also breaks the cycles
+    // of references between lists that forward to each other
+    ConnectionList *const flattened = res->m_flattened.exchange(0, std::memory_order_acq_rel);
+    if (flattened) {
+        ConnectionList::release(flattened);
+    }
+    ConnectionList::release(res);
+}
+
+void ConnectionList::retire(ConnectionList *connectionList)
+{
+    Epoch::retire(connectionList, &releaseConnectionList);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * One emission spread across a thread pool. The callbacks are split in units of work that the
+  * emitting thread and the workers take until there are none left. The emitting thread waits for
+  * all units to be done, not for all workers to start, so it never waits for a busy pool.
+  */
+class ParallelEmission
+{
+public:
+    ParallelEmission(const ConnectionList *connections, SignalBase::Invoke invoke,
+                     const void *param, const ichar *signalName, bool ordered, size_t threadCount);
+    ~ParallelEmission();
+
+    void ref();
+    void deref();
+
+    /**
+      * Takes units of work until there are none left.
+      */
+    void work();
+
+    /**
+      * Waits for all units of work to be done.
+      */
+    void wait();
+
+    size_t unitCount() const
+    {
+        return m_unitCount;
+    }
+
+private:
+    void runUnit(size_t unit);
+
+    const ConnectionList    *m_connections;
+    SignalBase::Invoke       m_invoke;
+    const void              *m_param;
+    const ichar             *m_signalName;
+    size_t                   m_unitCount;
+    size_t                   m_unitSize;
+    // In ordered mode, the indices of the callbacks of unit i are
+    // m_bucketIndices[m_bucketBegin[i]] .. m_bucketIndices[m_bucketBegin[i + 1] - 1]
+    size_t                  *m_bucketBegin;
+    size_t                  *m_bucketIndices;
+    std::atomic<size_t>      m_refs;
+    std::atomic<size_t>      m_nextUnit;
+    size_t                   m_doneUnits;
+    Mutex                    m_mutex;
+    CondVar                  m_condition;
+};
+
+class ParallelEmissionTask
+    : public ThreadPool::Task
+{
+public:
+    ParallelEmissionTask(ParallelEmission *parallelEmission)
+        : m_parallelEmission(parallelEmission)
+    {
+        m_parallelEmission->ref();
+    }
+
+    virtual ~ParallelEmissionTask()
+    {
+        m_parallelEmission->deref();
+    }
+
+    virtual void run()
+    {
+        m_parallelEmission->work();
+    }
+
+    ParallelEmission *const m_parallelEmission;
+};
+
+ParallelEmission::ParallelEmission(const ConnectionList *connections, SignalBase::Invoke invoke,
+                                   const void *param, const ichar *signalName, bool ordered, size_t threadCount)
+    : m_connections(connections)
+    , m_invoke(invoke)
+    , m_param(param)
+    , m_signalName(signalName)
+    , m_bucketBegin(0)
+    , m_bucketIndices(0)
+    , m_refs(1)
+    , m_nextUnit(0)
+    , m_doneUnits(0)
+    , m_condition(m_mutex)
+{
+    const size_t count = connections->m_count;
+    if (!ordered) {
+        // A few units per thread, so threads that finish early take work from the slow ones
+        m_unitSize = count / (threadCount * 4);
+        if (!m_unitSize) {
+            m_unitSize = 1;
+        }
+        m_unitCount = (count + m_unitSize - 1) / m_unitSize;
+        return;
+    }
+    // Callbacks are distributed in buckets by receiver, keeping the order they were connected
+    m_unitSize = 0;
+    m_unitCount = threadCount * 2 < count ? threadCount * 2 : count;
+    m_bucketBegin = (size_t*) calloc(m_unitCount + 1, sizeof(size_t));
+    m_bucketIndices = (size_t*) malloc(count * sizeof(size_t));
+    size_t *const bucket = (size_t*) malloc(count * sizeof(size_t));
+    for (size_t i = 0; i < count; ++i) {
+        const size_t receiver = (size_t) connections->m_callbacks[i]->m_receiver;
+        bucket[i] = ((receiver >> 4) ^ (receiver >> 12)) % m_unitCount;
+        ++m_bucketBegin[bucket[i] + 1];
+    }
+    for (size_t i = 0; i < m_unitCount; ++i) {
+        m_bucketBegin[i + 1] += m_bucketBegin[i];
+    }
+    size_t *const bucketEnd = (size_t*) malloc(m_unitCount * sizeof(size_t));
+    for (size_t i = 0; i < m_unitCount; ++i) {
+        bucketEnd[i] = m_bucketBegin[i];
+    }
+    for (size_t i = 0; i < count; ++i) {
+        m_bucketIndices[bucketEnd[bucket[i]]++] = i;
+    }
+    free(bucketEnd);
+    free(bucket);
+}
+
+ParallelEmission::~ParallelEmission()
+{
+    free(m_bucketBegin);
+    free(m_bucketIndices);
+}
+
+void ParallelEmission::ref()
+{
+    m_refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ParallelEmission::deref()
+{
+    if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+    }
+}
+
+void ParallelEmission::work()
+{
+    size_t done = 0;
+    size_t unit;
+    while ((unit = m_nextUnit.fetch_add(1, std::memory_order_relaxed)) < m_unitCount) {
+        runUnit(unit);
+        ++done;
+    }
+    if (!done) {
+        return;
+    }
+    ContextMutexLocker cml(m_mutex);
+    m_doneUnits += done;
+    if (m_doneUnits == m_unitCount) {
+        m_condition.broadcast();
+    }
+}
+
+void ParallelEmission::wait()
+{
+    ContextMutexLocker cml(m_mutex);
+    while (m_doneUnits < m_unitCount) {
+        m_condition.wait();
+    }
+}
+
+void ParallelEmission::runUnit(size_t unit)
+{
+    size_t begin;
+    size_t end;
+    if (m_unitSize) {
+        begin = unit * m_unitSize;
+        end = begin + m_unitSize < m_connections->m_count ? begin + m_unitSize : m_connections->m_count;
+    } else {
+        begin = m_bucketBegin[unit];
+        end = m_bucketBegin[unit + 1];
+    }
+    for (size_t i = begin; i < end; ++i) {
+        CallbackDummy *const callback = m_connections->m_callbacks[m_unitSize ? i : m_bucketIndices[i]];
+        if (!callback->isDisconnected()) {
+            SignalBase::invokeRecorded(m_invoke, callback, m_param, m_signalName);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+__thread SignalBase::EmitFrame *SignalBase::EmitFrame::m_current = 0;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SignalBase::~SignalBase()
+{
+    for (EmitFrame *emitFrame = EmitFrame::current(); emitFrame; emitFrame = emitFrame->m_previous) {
+        if (emitFrame->m_signal == this) {
+            emitFrame->m_destroyed = true;
+        }
+    }
+    removeAllConnections();
+    // The empty list kept when a thread pool or static slots were set
+    ConnectionList *const connections = m_connections.exchange(0, std::memory_order_seq_cst);
+    if (connections) {
+        if (connections->m_staticSlots) {
+            // Flattened lists of other signals can still reference them
+            connections->m_staticSlots->m_disconnected.store(true, std::memory_order_release);
+        }
+        ConnectionList::retire(connections);
+    }
+#ifdef IDEAL_SIGNAL_METRICS
+    SignalMetrics::unregisterSignal(m_metrics);
+#endif
+}
+
+void SignalBase::setThreadPool(ThreadPool *threadPool) const
+{
+    ConnectionList *oldConnections;
+    {
+        Epoch::Guard guard;
+        oldConnections = m_connections.load(std::memory_order_seq_cst);
+        ConnectionList *connections;
+        size_t copied;
+        do {
+            if (!oldConnections && !threadPool) {
+                return;
+            }
+            connections = ConnectionList::copy(oldConnections, 0, threadPool, copied);
+            if (!copied && !threadPool && !connections->m_staticSlots) {
+                free(connections);
+                connections = 0;
+            }
+            if (m_connections.compare_exchange_strong(oldConnections, connections, std::memory_order_seq_cst)) {
+                break;
+            }
+            if (connections) {
+                ConnectionList::discard(connections, copied);
+            }
+        } while (true);
+    }
+    if (oldConnections) {
+        ConnectionList::retire(oldConnections);
+    }
+}
+
+void SignalBase::setStaticSlots(CallbackDummy *staticSlots) const
+{
+#ifdef IDEAL_SIGNAL_METRICS
+    staticSlots->m_metrics = SignalMetrics::registerSlot(m_metrics, staticSlots->m_receiver);
+#endif
+    // Nothing else can access the signal while it is constructed
+    ConnectionList *const connections = ConnectionList::make(0, 0);
+    connections->m_staticSlots = staticSlots;
+    m_connections.store(connections, std::memory_order_seq_cst);
+}
+
+void SignalBase::addConnection(CallbackDummy *callback) const
+{
+#ifdef IDEAL_SIGNAL_METRICS
+    callback->m_metrics = SignalMetrics::registerSlot(m_metrics, callback->m_receiver);
+#endif
+    ConnectionList *oldConnections;
+    {
+        Epoch::Guard guard;
+        oldConnections = m_connections.load(std::memory_order_seq_cst);
+        ConnectionList *connections;
+        size_t copied;
+        do {
+            // Disconnected callbacks are dropped while copying
+            connections = ConnectionList::copy(oldConnections, 1, oldConnections ? oldConnections->m_threadPool : 0, copied);
+            // Callbacks are kept sorted by decreasing priority, in connection order for the same one
+            size_t position = copied;
+            while (position && connections->m_callbacks[position - 1]->priority() < callback->priority()) {
+                connections->m_callbacks[position] = connections->m_callbacks[position - 1];
+                --position;
+            }
+            connections->m_callbacks[position] = callback;
+            if (callback->forwardedSignal()) {
+                connections->m_hasForwards = true;
+            }
+            if (m_connections.compare_exchange_strong(oldConnections, connections, std::memory_order_seq_cst)) {
+                break;
+            }
+            ConnectionList::discard(connections, copied);
+        } while (true);
+    }
+    if (oldConnections) {
+        ConnectionList::retire(oldConnections);
+    }
+}
+
+void SignalBase::setPriority(CallbackDummy *callback, iint32 priority) const
+{
+    callback->m_priority.store(priority, std::memory_order_relaxed);
+    ConnectionList *oldConnections;
+    {
+        Epoch::Guard guard;
+        oldConnections = m_connections.load(std::memory_order_seq_cst);
+        ConnectionList *connections;
+        size_t copied;
+        do {
+            if (!oldConnections) {
+                return;
+            }
+            connections = ConnectionList::copy(oldConnections, 0, oldConnections->m_threadPool, copied);
+            // Stable insertion sort, the list is almost sorted
+            for (size_t i = 1; i < copied; ++i) {
+                CallbackDummy *const curr = connections->m_callbacks[i];
+                size_t j = i;
+                while (j && connections->m_callbacks[j - 1]->priority() < curr->priority()) {
+                    connections->m_callbacks[j] = connections->m_callbacks[j - 1];
+                    --j;
+                }
+                connections->m_callbacks[j] = curr;
+            }
+            if (m_connections.compare_exchange_strong(oldConnections, connections, std::memory_order_seq_cst)) {
+                break;
+            }
+            ConnectionList::discard(connections, copied);
+        } while (true);
+    }
+    ConnectionList::retire(oldConnections);
+}
+
+bool SignalBase::removeConnection(CallbackDummy *callback) const
+{
+    if (!disconnectCallback(callback)) {
+        return false;
+    }
+    compactConnections();
+    return true;
+}
+
+bool SignalBase::disconnectCallback(CallbackDummy *callback) const
+{
+    // A callback is only flagged once, and emissions skip it from then on
+    if (callback->m_disconnected.exchange(true, std::memory_order_acq_rel)) {
+        return false;
+    }
+    // If the list was replaced meanwhile this is counted on the new one, which at worst makes it
+    // be compacted a bit early
+    Epoch::Guard guard;
+    ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+    if (connections) {
+        connections->m_disconnectedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void SignalBase::compactConnections() const
+{
+    ConnectionList *oldConnections;
+    {
+        Epoch::Guard guard;
+        oldConnections = m_connections.load(std::memory_order_seq_cst);
+        if (!oldConnections ||
+            oldConnections->m_disconnectedCount.load(std::memory_order_relaxed) * 2 <= oldConnections->m_count) {
+            return;
+        }
+        size_t copied;
+        ConnectionList *connections = ConnectionList::copy(oldConnections, 0, oldConnections->m_threadPool, copied);
+        if (!copied && !connections->m_threadPool && !connections->m_staticSlots) {
+            free(connections);
+            connections = 0;
+        }
+        if (!m_connections.compare_exchange_strong(oldConnections, connections, std::memory_order_seq_cst)) {
+            if (connections) {
+                ConnectionList::discard(connections, copied);
+            }
+            return;
+        }
+    }
+    ConnectionList::retire(oldConnections);
+}
+
+void SignalBase::removeAllConnections() const
+{
+    ConnectionList *oldConnections;
+    {
+        Epoch::Guard guard;
+        oldConnections = m_connections.load(std::memory_order_seq_cst);
+        ConnectionList *connections;
+        do {
+            if (!oldConnections) {
+                return;
+            }
+            connections = 0;
+            if (oldConnections->m_threadPool || oldConnections->m_staticSlots) {
+                connections = ConnectionList::make(0, oldConnections->m_threadPool);
+                connections->m_staticSlots = oldConnections->m_staticSlots;
+                if (connections->m_staticSlots) {
+                    connections->m_staticSlots->ref();
+                }
+            }
+            if (m_connections.compare_exchange_strong(oldConnections, connections, std::memory_order_seq_cst)) {
+                break;
+            }
+            if (connections) {
+                ConnectionList::discard(connections, 0);
+            }
+        } while (true);
+    }
+    // Unpublished, but emissions that loaded it before can still be iterating it
+    for (size_t i = 0; i < oldConnections->m_count; ++i) {
+        oldConnections->m_callbacks[i]->m_disconnected.store(true, std::memory_order_release);
+    }
+    ConnectionList::retire(oldConnections);
+}
+
+const ConnectionList *SignalBase::flattenedConnections(const ConnectionList *connections)
+{
+    ConnectionList *oldFlattened = connections->m_flattened.load(std::memory_order_acquire);
+    if (oldFlattened && isFlattenedValid(oldFlattened)) {
+        return oldFlattened;
+    }
+    // Chains can change while we walk them, in which case we retry with the new counts
+    size_t linkCount = 0;
+    size_t count = flatten(connections, 0, 0, 0, 0, 0, linkCount, 0);
+    ConnectionList *flattened;
+    do {
+        flattened = ConnectionList::make(count, 0);
+        flattened->m_links = (ConnectionList::ForwardLink*) malloc(linkCount * sizeof(ConnectionList::ForwardLink));
+        size_t newLinkCount = 0;
+        const size_t newCount = flatten(connections, flattened->m_callbacks, count, 0, flattened->m_links, linkCount,
+                                        newLinkCount, 0);
+        if (newCount <= count && newLinkCount <= linkCount) {
+            flattened->m_count = newCount;
+            flattened->m_linkCount = newLinkCount;
+            break;
+        }
+        free(flattened->m_links);
+        free(flattened);
+        count = newCount;
+        linkCount = newLinkCount;
+    } while (true);
+    for (size_t i = 0; i < flattened->m_count; ++i) {
+        flattened->m_callbacks[i]->ref();
+    }
+    // The lists walked are alive while our guard exists, so they can still be referenced
+    for (size_t i = 0; i < flattened->m_linkCount; ++i) {
+        const ConnectionList::ForwardLink &link = flattened->m_links[i];
+        link.forward->ref();
+        if (link.connections) {
+            link.connections->m_refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    ConnectionList *const mutableConnections = const_cast<ConnectionList*>(connections);
+    if (mutableConnections->m_flattened.compare_exchange_strong(oldFlattened, flattened, std::memory_order_acq_rel)) {
+        if (oldFlattened) {
+            ConnectionList::retire(oldFlattened);
+        }
+    } else {
+        // Another emission cached its own. Ours is freed once our guard is released
+        ConnectionList::retire(flattened);
+    }
+    return flattened;
+}
+
+bool SignalBase::isFlattenedValid(const ConnectionList *flattened)
+{
+    for (size_t i = 0; i < flattened->m_linkCount; ++i) {
+        const ConnectionList::ForwardLink &link = flattened->m_links[i];
+        // The signal is only accessed while the forward to it is connected
+        if (link.forward->isDisconnected() ||
+            link.signal->m_connections.load(std::memory_order_seq_cst) != link.connections ||
+            (link.signal->m_parent->isEmitBlocked() && !link.signal->m_isDestroyedSignal) != link.emitBlocked) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t SignalBase::flatten(const ConnectionList *connections, CallbackDummy **callbacks, size_t capacity, size_t offset,
+                           ConnectionList::ForwardLink *links, size_t linkCapacity, size_t &linkCount, size_t depth)
+{
+    // Deeper chains, and cycles, are left to SignalCallback
+    static const size_t maxDepth = 8;
+    size_t count = 0;
+    for (size_t i = 0; i < connections->m_count; ++i) {
+        CallbackDummy *const curr = connections->m_callbacks[i];
+        if (curr->isDisconnected()) {
+            continue;
+        }
+        const SignalBase *const signal = curr->forwardedSignal();
+        if (signal && depth < maxDepth) {
+            ConnectionList *const forwarded = signal->m_connections.load(std::memory_order_seq_cst);
+            const bool emitBlocked = signal->m_parent->isEmitBlocked() && !signal->m_isDestroyedSignal;
+            // Reserved before walking the signal, so the links walked through it follow
+            const size_t linkIndex = linkCount++;
+            const size_t begin = count;
+            if (!emitBlocked && forwarded) {
+                if (forwarded->m_staticSlots) {
+                    if (count < capacity) {
+                        callbacks[count] = forwarded->m_staticSlots;
+                    }
+                    ++count;
+                }
+                count += flatten(forwarded, count < capacity ? callbacks + count : 0,
+                                 count < capacity ? capacity - count : 0, offset + count, links, linkCapacity,
+                                 linkCount, depth + 1);
+            }
+            if (linkIndex < linkCapacity) {
+                ConnectionList::ForwardLink &link = links[linkIndex];
+                link.forward = curr;
+                link.signal = signal;
+                link.connections = forwarded;
+                link.emitBlocked = emitBlocked;
+                link.begin = offset + begin;
+                link.end = offset + count;
+                link.linkEnd = linkCount;
+            }
+            continue;
+        }
+        if (count < capacity) {
+            callbacks[count] = curr;
+        }
+        ++count;
+    }
+    return count;
+}
+
+void SignalBase::emitOnThreadPool(Invoke invoke, const void *param, bool ordered) const
+{
+    if (m_parent->isEmitBlocked() && !m_isDestroyedSignal) {
+        return;
+    }
+    const iuint64 traceStart = SignalTrace::isEnabled() ? SignalTrace::now() : 0;
+#ifdef IDEAL_SIGNAL_METRICS
+    const iuint64 emitStart = SignalMetrics::now();
+#endif
+    // The snapshot is kept alive while the guard exists, as in emit()
+    Epoch::Guard guard;
+    const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+    // Static slots are called on the calling thread, before the connected callbacks
+    if (connections && connections->m_staticSlots) {
+        invokeRecorded(invoke, connections->m_staticSlots, param, m_name);
+    }
+    ThreadPool *const threadPool = connections && connections->m_threadPool ? connections->m_threadPool
+                                                                            : ThreadPool::globalInstance();
+    if (connections && connections->m_count > 1 && threadPool->threadCount() > 1) {
+        ParallelEmission *const parallelEmission =
+            new ParallelEmission(connections, invoke, param, m_name, ordered, threadPool->threadCount());
+        const size_t unitCount = parallelEmission->unitCount();
+        const size_t helperCount = unitCount - 1 < threadPool->threadCount() ? unitCount - 1
+                                                                              : threadPool->threadCount();
+        for (size_t i = 0; i < helperCount; ++i) {
+            threadPool->start(new ParallelEmissionTask(parallelEmission));
+        }
+        parallelEmission->work();
+        parallelEmission->wait();
+        parallelEmission->deref();
+    } else if (connections) {
+        for (size_t i = 0; i < connections->m_count; ++i) {
+            CallbackDummy *const callback = connections->m_callbacks[i];
+            if (!callback->isDisconnected()) {
+                invokeRecorded(invoke, callback, param, m_name);
+            }
+        }
+    }
+#ifdef IDEAL_SIGNAL_METRICS
+    recordEmit(SignalMetrics::now() - emitStart);
+#endif
+    if (IDEAL_UNLIKELY(traceStart)) {
+        SignalTrace::record(SignalTrace::Emission, m_name, m_parent, traceStart);
+    }
+}
+
+void SignalBase::invokeRecorded(Invoke invoke, CallbackDummy *callback, const void *param, const ichar *signalName)
+{
+    const bool tracing = SignalTrace::isEnabled();
+#ifdef IDEAL_SIGNAL_METRICS
+    const iuint64 callStart = SignalMetrics::now();
+#else
+    const iuint64 callStart = tracing ? SignalTrace::now() : 0;
+#endif
+    invoke(callback, param);
+#ifdef IDEAL_SIGNAL_METRICS
+    recordCall(callback, SignalMetrics::now() - callStart);
+#endif
+    if (IDEAL_UNLIKELY(tracing)) {
+        SignalTrace::record(SignalTrace::Call, signalName, callback->m_receiver, callStart);
+    }
+}
+
+}
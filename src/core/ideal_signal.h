@@ -21,30 +21,193 @@
 #ifndef IDEAL_SIGNAL_H
 #define IDEAL_SIGNAL_H
 
+#include <ideal_export.h>
+#include <core/connection.h>
+#include <core/delivery_policy.h>
+#include <core/epoch.h>
+#include <core/signal_trace.h>
+#ifdef IDEAL_SIGNAL_METRICS
+#include <core/signal_metrics.h>
+#endif
 #include <core/mutex.h>
+#include <core/context_mutex_locker.h>
 #include <core/list.h>
 #include <core/signal_resource.h>
+#include <core/vector.h>
+
+#include <atomic>
+#include <tuple>
+#include <type_traits>
 
 namespace IdealCore {
 
 class Object;
 class SignalBase;
-
-static List<SignalBase*> deletedSignalsOnEmit;
-static Mutex deletedSignalsOnEmitMutex;
+class EventLoop;
+class SharedMemoryChannel;
+class ThreadPool;
 
 /**
   * @internal
+  *
+  * Callbacks are shared by all connection snapshots that contain them, and are deleted when the
+  * last of them is released.
   */
 class CallbackDummy
 {
 public:
+    CallbackDummy()
+        : m_refs(1)
+        , m_disconnected(false)
+        , m_priority(0)
+#ifdef IDEAL_SIGNAL_METRICS
+        , m_metrics(0)
+#endif
+    {
+    }
+
     virtual ~CallbackDummy()
     {
+#ifdef IDEAL_SIGNAL_METRICS
+        if (m_metrics) {
+            SignalMetrics::unregisterSlot(m_metrics);
+        }
+#endif
         m_receiver = 0;
     }
 
-    SignalResource *m_receiver;
+    void ref()
+    {
+        m_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void deref()
+    {
+        if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    /**
+      * @return The signal this callback forwards to. 0 if it is not a forward.
+      */
+    virtual const SignalBase *forwardedSignal() const
+    {
+        return 0;
+    }
+
+    /**
+      * @return Whether this callback was disconnected. An emission that started before the
+      *         disconnection can still see it on its snapshot, and has to skip it.
+      */
+    bool isDisconnected() const
+    {
+        return m_disconnected.load(std::memory_order_acquire);
+    }
+
+    /**
+      * @return The priority given with Connection::setPriority(). Callbacks with higher priority
+      *         are called first.
+      */
+    iint32 priority() const
+    {
+        return m_priority.load(std::memory_order_relaxed);
+    }
+
+    SignalResource      *m_receiver;
+    std::atomic<size_t>  m_refs;
+    std::atomic<bool>    m_disconnected;
+    std::atomic<iint32>  m_priority;
+#ifdef IDEAL_SIGNAL_METRICS
+    SignalMetrics::Slot *m_metrics;
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * An immutable array with the callbacks connected to a signal at a given moment. Connecting and
+  * disconnecting never modify a published list: they create a new one and swap it in with a
+  * compare and exchange, so emit() can iterate the current list without locking and without copying
+  * it. Replaced lists are freed through Epoch once no emission can be iterating them.
+  *
+  * The list is all the connection state of a signal, so a signal that was never connected only
+  * holds a null pointer, and no memory is allocated for it until the first connection. A
+  * StaticSignal always has a list, which holds its static slots.
+  */
+class IDEAL_EXPORT ConnectionList
+{
+public:
+    /**
+      * A forward to another signal that was walked while flattening a list, and what was seen
+      * through it. The flattened list is valid while all of its links are unchanged. Links are
+      * stored in the order they were walked, so the links walked through this one follow it.
+      */
+    struct ForwardLink
+    {
+        CallbackDummy    *forward;        ///< Referenced, to check whether it was disconnected
+        const SignalBase *signal;
+        ConnectionList   *connections;    ///< Referenced, so its address is not reused meanwhile
+        bool              emitBlocked;
+        size_t            begin;          ///< The first callback reached through this forward
+        size_t            end;            ///< One past the last callback reached through this forward
+        size_t            linkEnd;        ///< One past the last link walked through this forward
+    };
+
+    /**
+      * @return A new list with room for @p count callbacks, which are not initialized, and using
+      *         @p threadPool for parallel emissions.
+      */
+    static ConnectionList *make(size_t count, ThreadPool *threadPool);
+
+    /**
+      * @return A new list with the callbacks of @p connectionList that are not disconnected, plus
+      *         room for @p extra callbacks at the end, which are not initialized. @p connectionList
+      *         can be 0. The number of callbacks copied is stored in @p copied. The static slots
+      *         are kept.
+      */
+    static ConnectionList *copy(const ConnectionList *connectionList, size_t extra, ThreadPool *threadPool, size_t &copied);
+
+    /**
+      * Releases all callbacks and links of @p connectionList and frees it.
+      */
+    static void destroy(ConnectionList *connectionList);
+
+    /**
+      * Releases a reference to @p connectionList, destroying it if it was the last one.
+      */
+    static void release(ConnectionList *connectionList);
+
+    /**
+      * Releases the first @p count callbacks and the static slots of @p connectionList and frees
+      * it. For lists that could not be published.
+      */
+    static void discard(ConnectionList *connectionList, size_t count);
+
+    /**
+      * Drops the flattened list of @p connectionList and releases it once no thread can be
+      * iterating it.
+      */
+    static void retire(ConnectionList *connectionList);
+
+    size_t                        m_count;
+    // Approximate: only used to decide when to compact
+    std::atomic<size_t>           m_disconnectedCount;
+    ThreadPool                   *m_threadPool;
+    // Called before the callbacks. Only set on lists of a StaticSignal
+    CallbackDummy                *m_staticSlots;
+    // Whether some callback is a forward to another signal
+    bool                          m_hasForwards;
+    // One for being published, plus one for each flattened list it is a link of
+    std::atomic<size_t>           m_refs;
+    // The forwards walked, if it is a flattened list
+    ForwardLink                  *m_links;
+    size_t                        m_linkCount;
+    // Forwards replaced by the callbacks they end up calling, built on the first emission
+    std::atomic<ConnectionList*>  m_flattened;
+    CallbackDummy                *m_callbacks[1];
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -63,6 +226,30 @@ public:
 
     virtual void operator()(const Param&... param) = 0;
 
+    /**
+      * Calls the slot.
+      *
+      * @return Whether the slot handled the emission, which is what it returned if it returns a
+      *         bool. Slots returning anything else never handle it.
+      */
+    virtual bool callHandled(const Param&... param)
+    {
+        (*this)(param...);
+        return false;
+    }
+
+    /**
+      * Calls the slot once with all of @p batch, if it takes batches.
+      *
+      * @return Whether the slot takes batches. If it does not, nothing was called, and
+      *         Signal::emitBatch() calls it once for each element of @p batch.
+      */
+    virtual bool callBatch(const Vector<std::tuple<Param...> > &batch)
+    {
+        IDEAL_UNUSED(batch);
+        return false;
+    }
+
     template <typename Receiver, typename Member>
     static CallbackBase<Param...> *make(Receiver *receiver, Member member);
 
@@ -75,6 +262,18 @@ public:
     template <typename Receiver, typename Member>
     static CallbackBase<Param...> *makeMultiSynchronized(SignalResource *resource, Receiver *receiver, Member member, Mutex &mutex);
 
+    template <typename Receiver, typename Member>
+    static CallbackBase<Param...> *makeQueued(Receiver *receiver, Member member, EventLoop &eventLoop,
+                                              const DeliveryPolicy &deliveryPolicy, const ichar *signalName);
+
+    static CallbackBase<Param...> *makeShared(SharedMemoryChannel &channel);
+
+    template <typename Functor>
+    static CallbackBase<Param...> *makeFunctor(const Functor &functor);
+
+    template <typename Receiver, typename Member>
+    static CallbackBase<Param...> *makeBatch(Receiver *receiver, Member member);
+
     template <typename Member>
     static CallbackBase<Param...> *makeStatic(Member member);
 
@@ -92,6 +291,80 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+  * @internal
+  *
+  * Calls a slot and tells whether it handled the emission: slots returning a bool handle it when
+  * they return true, other slots never do.
+  */
+template <typename Result>
+struct SlotResult
+{
+    template <typename Receiver, typename Member, typename... Param>
+    static bool callMember(Receiver *receiver, Member member, const Param&... param)
+    {
+        (receiver->*member)(param...);
+        return false;
+    }
+
+    template <typename Function, typename... Param>
+    static bool callFunction(Function &function, const Param&... param)
+    {
+        function(param...);
+        return false;
+    }
+};
+
+template <>
+struct SlotResult<bool>
+{
+    template <typename Receiver, typename Member, typename... Param>
+    static bool callMember(Receiver *receiver, Member member, const Param&... param)
+    {
+        return (receiver->*member)(param...);
+    }
+
+    template <typename Function, typename... Param>
+    static bool callFunction(Function &function, const Param&... param)
+    {
+        return function(param...);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * The list of slots of a StaticSignal, called in the order they are listed. The lists that are
+  * not empty are defined in static_signal.h. Plain signals call the empty one.
+  */
+template <typename... Slot>
+struct StaticSlotList;
+
+template <>
+struct StaticSlotList<>
+{
+    template <typename Owner>
+    struct AcceptsOwner
+        : std::true_type
+    {
+    };
+
+    template <typename... Param>
+    static inline void call(SignalResource *, const Param&...)
+    {
+    }
+
+    template <typename... Param>
+    static inline bool callHandled(SignalResource *, const Param&...)
+    {
+        return false;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /**
   * @internal
   */
@@ -108,15 +381,19 @@ public:
 
     virtual void operator()(const Param&... param)
     {
-        Receiver *receiver = 0;
-        {
-            ContextMutexLocker cml(this->m_receiver->m_mutex);
-            if (static_cast<Receiver*>(this->m_receiver)->areSignalsBlocked()) {
-                return;
-            }
-            receiver = static_cast<Receiver*>(this->m_receiver);
+        if (this->m_receiver->areSignalsBlocked()) {
+            return;
         }
-        (receiver->*m_member)(param...);
+        (static_cast<Receiver*>(this->m_receiver)->*m_member)(param...);
+    }
+
+    virtual bool callHandled(const Param&... param)
+    {
+        if (this->m_receiver->areSignalsBlocked()) {
+            return false;
+        }
+        typedef decltype((std::declval<Receiver*>()->*std::declval<Member>())(param...)) Result;
+        return SlotResult<Result>::callMember(static_cast<Receiver*>(this->m_receiver), m_member, param...);
     }
 
     Member m_member;
@@ -144,6 +421,12 @@ public:
         Callback<Receiver, Member, Param...>::operator()(param...);
     }
 
+    virtual bool callHandled(const Param&... param)
+    {
+        ContextMutexLocker cml(m_mutex);
+        return Callback<Receiver, Member, Param...>::callHandled(param...);
+    }
+
     Mutex &m_mutex;
 };
 
@@ -166,15 +449,19 @@ public:
 
     virtual void operator()(const Param&... param)
     {
-        Receiver *receiver = 0;
-        {
-            ContextMutexLocker cml(this->m_receiver->m_mutex);
-            if (static_cast<Receiver*>(this->m_receiver)->areSignalsBlocked()) {
-                return;
-            }
-            receiver = static_cast<Receiver*>(this->m_receiver);
+        if (this->m_receiver->areSignalsBlocked()) {
+            return;
+        }
+        (static_cast<Receiver*>(this->m_receiver)->*m_member)(m_sender, param...);
+    }
+
+    virtual bool callHandled(const Param&... param)
+    {
+        if (this->m_receiver->areSignalsBlocked()) {
+            return false;
         }
-        (receiver->*m_member)(m_sender, param...);
+        typedef decltype((std::declval<Receiver*>()->*std::declval<Member>())(m_sender, param...)) Result;
+        return SlotResult<Result>::callMember(static_cast<Receiver*>(this->m_receiver), m_member, m_sender, param...);
     }
 
     Member         m_member;
@@ -203,11 +490,58 @@ public:
         CallbackMulti<Receiver, Member, Param...>::operator()(param...);
     }
 
+    virtual bool callHandled(const Param&... param)
+    {
+        ContextMutexLocker cml(m_mutex);
+        return CallbackMulti<Receiver, Member, Param...>::callHandled(param...);
+    }
+
     Mutex &m_mutex;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+  * @internal
+  *
+  * Compile time list of the indices of a parameter pack, used to expand a tuple into arguments.
+  */
+template <size_t... Index>
+struct IndexList
+{
+};
+
+template <size_t N, size_t... Index>
+struct MakeIndexList
+    : public MakeIndexList<N - 1, N - 1, Index...>
+{
+};
+
+template <size_t... Index>
+struct MakeIndexList<0, Index...>
+{
+    typedef IndexList<Index...> Type;
+};
+
+/**
+  * @internal
+  *
+  * Whether all types of a parameter pack can be copied with memcpy().
+  */
+template <typename... Param>
+struct AreTriviallyCopyable
+{
+    static const bool value = true;
+};
+
+template <typename First, typename... Rest>
+struct AreTriviallyCopyable<First, Rest...>
+{
+    static const bool value = std::is_trivially_copyable<First>::value && AreTriviallyCopyable<Rest...>::value;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /**
   * @internal
   */
@@ -227,11 +561,113 @@ public:
         (*m_member)(param...);
     }
 
+    virtual bool callHandled(const Param&... param)
+    {
+        typedef decltype((*m_member)(param...)) Result;
+        return SlotResult<Result>::callFunction(*m_member, param...);
+    }
+
     Member m_member;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+  * @internal
+  *
+  * The functor is stored inside the callback, so connecting a lambda allocates nothing but the
+  * callback itself, and emitting calls it through the single virtual call every callback has.
+  */
+template <typename Functor, typename... Param>
+class CallbackFunctor
+    : public CallbackBase<Param...>
+{
+public:
+    CallbackFunctor(const Functor &functor)
+        : m_functor(functor)
+    {
+        this->m_receiver = 0;
+    }
+
+    virtual void operator()(const Param&... param)
+    {
+        m_functor(param...);
+    }
+
+    virtual bool callHandled(const Param&... param)
+    {
+        typedef decltype(m_functor(param...)) Result;
+        return SlotResult<Result>::callFunction(m_functor, param...);
+    }
+
+    Functor m_functor;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * A slot taking all the arguments of an emitBatch() at once. Each emit() reaches it as a batch of
+  * one element. Each thread reuses the same one, so that does not allocate memory.
+  */
+template <typename Receiver, typename Member, typename... Param>
+class CallbackBatch
+    : public CallbackBase<Param...>
+{
+public:
+    CallbackBatch(Receiver *receiver, Member member)
+        : m_member(member)
+    {
+        this->m_receiver = receiver;
+    }
+
+    virtual void operator()(const Param&... param)
+    {
+        if (this->m_receiver->areSignalsBlocked()) {
+            return;
+        }
+        static thread_local SingleBatch singleBatch;
+        if (singleBatch.m_inUse) {
+            // The slot emitted again while it was being called
+            Vector<std::tuple<Param...> > batch;
+            batch.append(std::tuple<Param...>(param...));
+            (static_cast<Receiver*>(this->m_receiver)->*m_member)(batch);
+            return;
+        }
+        singleBatch.m_inUse = true;
+        // Assigning does not copy the vector unless the slot kept a copy of it
+        singleBatch.m_batch[0] = std::tuple<Param...>(param...);
+        (static_cast<Receiver*>(this->m_receiver)->*m_member)(singleBatch.m_batch);
+        singleBatch.m_inUse = false;
+    }
+
+    virtual bool callBatch(const Vector<std::tuple<Param...> > &batch)
+    {
+        if (!this->m_receiver->areSignalsBlocked()) {
+            (static_cast<Receiver*>(this->m_receiver)->*m_member)(batch);
+        }
+        return true;
+    }
+
+    Member m_member;
+
+private:
+    struct SingleBatch
+    {
+        SingleBatch()
+            : m_inUse(false)
+        {
+            m_batch.append(std::tuple<Param...>());
+        }
+
+        Vector<std::tuple<Param...> > m_batch;
+        bool                          m_inUse;
+    };
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /**
   * @internal
   */
@@ -252,6 +688,12 @@ public:
         CallbackStatic<Member, Param...>::operator()(param...);
     }
 
+    virtual bool callHandled(const Param&... param)
+    {
+        ContextMutexLocker cml(m_mutex);
+        return CallbackStatic<Member, Param...>::callHandled(param...);
+    }
+
     Mutex &m_mutex;
 };
 
@@ -277,6 +719,12 @@ public:
         (*m_member)(m_sender, param...);
     }
 
+    virtual bool callHandled(const Param&... param)
+    {
+        typedef decltype((*m_member)(m_sender, param...)) Result;
+        return SlotResult<Result>::callFunction(*m_member, m_sender, param...);
+    }
+
     Member         m_member;
     Object * const m_sender;
 };
@@ -303,6 +751,12 @@ public:
         CallbackStaticMulti<Member, Param...>::operator()(param...);
     }
 
+    virtual bool callHandled(const Param&... param)
+    {
+        ContextMutexLocker cml(m_mutex);
+        return CallbackStaticMulti<Member, Param...>::callHandled(param...);
+    }
+
     Mutex &m_mutex;
 };
 
@@ -356,6 +810,30 @@ CallbackBase<Param...> *CallbackBase<Param...>::makeMultiSynchronized(SignalReso
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+  * @internal
+  */
+template <typename... Param>
+template <typename Functor>
+CallbackBase<Param...> *CallbackBase<Param...>::makeFunctor(const Functor &functor)
+{
+    return new CallbackFunctor<Functor, Param...>(functor);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  */
+template <typename... Param>
+template <typename Receiver, typename Member>
+CallbackBase<Param...> *CallbackBase<Param...>::makeBatch(Receiver *receiver, Member member)
+{
+    return new CallbackBatch<Receiver, Member, Param...>(receiver, member);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /**
   * @internal
   */
@@ -407,58 +885,123 @@ CallbackBase<Param...> *CallbackBase<Param...>::makeStaticMultiSynchronized(Sign
 /**
   * @internal
   */
-class SignalBase
+class IDEAL_EXPORT SignalBase
 {
     friend class Object;
+    friend class Connection;
+    friend class ParallelEmission;
+    friend class SignalResource;
 
 public:
     SignalBase(SignalResource *parent)
         : m_parent(parent)
         , m_isDestroyedSignal(true)
-        , m_connectionsMutex(Mutex::Recursive)
-        , m_beingEmitted(false)
-        , m_beingEmittedMutex(Mutex::Recursive)
+        , m_name("destroyed")
+        , m_connections(0)
+#ifdef IDEAL_SIGNAL_METRICS
+        , m_metrics(SignalMetrics::registerSignal("destroyed", "", parent))
+#endif
     {
         parent->signalCreated(this);
     }
 
-    SignalBase(SignalResource *parent, const ichar */* name */, const ichar */* signature */)
+    SignalBase(SignalResource *parent, const ichar *name, const ichar *signature)
         : m_parent(parent)
         , m_isDestroyedSignal(false)
-        , m_connectionsMutex(Mutex::Recursive)
-        , m_beingEmitted(false)
-        , m_beingEmittedMutex(Mutex::Recursive)
+        , m_name(name)
+        , m_connections(0)
+#ifdef IDEAL_SIGNAL_METRICS
+        , m_metrics(SignalMetrics::registerSignal(name, signature, parent))
+#endif
     {
+#ifndef IDEAL_SIGNAL_METRICS
+        IDEAL_UNUSED(signature);
+#endif
         parent->signalCreated(this);
     }
 
-    virtual ~SignalBase()
-    {
-        ContextMutexLocker cml(m_beingEmittedMutex);
-        if (m_beingEmitted) {
-            ContextMutexLocker cml(deletedSignalsOnEmitMutex);
-            deletedSignalsOnEmit.push_back(this);
-        }
-    }
+    virtual ~SignalBase();
 
     SignalResource *parent() const
     {
         return m_parent;
     }
 
+    /**
+      * @return The name given to IDEAL_SIGNAL_INIT.
+      */
+    const ichar *name() const
+    {
+        return m_name;
+    }
+
     virtual void disconnect(SignalResource *receiver) const = 0;
 
     void disconnect() const
     {
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            delete *it;
-        }
-        m_connections.clear();
+        removeAllConnections();
     }
 
+    /**
+      * Sets the pool whose workers call the slots on parallel emissions. By default, and if
+      * @p threadPool is 0, ThreadPool::globalInstance() is used.
+      */
+    void setThreadPool(ThreadPool *threadPool) const;
+
+#ifdef IDEAL_SIGNAL_METRICS
+    /**
+      * @return The metrics of this signal. See SignalMetrics.
+      */
+    const SignalMetrics::Record *metrics() const
+    {
+        return m_metrics;
+    }
+#endif
+
 protected:
+    /**
+      * @internal
+      *
+      * Each emit() in progress on a thread has an EmitFrame on its stack. Frames of the same thread
+      * are linked, so when a signal is destroyed from one of its slots it can flag the frames of
+      * the emissions it is part of, and those emissions stop without touching it again. Only the
+      * current thread is involved: no lock is needed.
+      */
+    class IDEAL_EXPORT EmitFrame
+    {
+    public:
+        EmitFrame(const SignalBase *signal)
+            : m_signal(signal)
+            , m_destroyed(false)
+            , m_previous(current())
+        {
+            current() = this;
+        }
+
+        ~EmitFrame()
+        {
+            current() = m_previous;
+            if (!m_previous && IDEAL_UNLIKELY(SignalResource::m_deferredDeletions != 0)) {
+                SignalResource::deleteDeferred();
+            }
+        }
+
+        /**
+          * @return The innermost emission in progress on the calling thread. 0 if none.
+          */
+        static EmitFrame *&current()
+        {
+            return m_current;
+        }
+
+        const SignalBase *const m_signal;
+        bool                    m_destroyed;
+        EmitFrame        *const m_previous;
+
+    private:
+        static __thread EmitFrame *m_current;
+    };
+
     static void notifyReceiverConnection(SignalResource *receiver, const SignalBase *signalBase)
     {
         if (!signalBase->m_isDestroyedSignal) {
@@ -475,12 +1018,129 @@ protected:
         }
     }
 
-    SignalResource       * const m_parent;
-    const bool                   m_isDestroyedSignal;
-    mutable List<CallbackDummy*> m_connections;
-    mutable Mutex                m_connectionsMutex;
-    mutable bool                 m_beingEmitted;
-    mutable Mutex                m_beingEmittedMutex;
+    /**
+      * Makes @p staticSlots be called before the connected callbacks on every emission, including
+      * the ones reaching this signal through a forward. Used by StaticSignal from its constructor,
+      * and takes the reference the caller holds on @p staticSlots.
+      */
+    void setStaticSlots(CallbackDummy *staticSlots) const;
+
+    /**
+      * Publishes a new snapshot with @p callback after all callbacks with the same or higher
+      * priority. The reference the caller holds on @p callback is transferred to the snapshot.
+      * Never blocks: it is retried if another thread publishes a snapshot meanwhile.
+      */
+    void addConnection(CallbackDummy *callback) const;
+
+    /**
+      * Marks @p callback as disconnected, which takes constant time. Disconnected callbacks are
+      * removed from the snapshot once they are half of it.
+      *
+      * @return Whether @p callback was connected.
+      */
+    bool removeConnection(CallbackDummy *callback) const;
+
+    /**
+      * Sets the priority of @p callback, and publishes a snapshot where it is placed after the
+      * callbacks with the same or higher priority that were before it, and before the rest.
+      */
+    void setPriority(CallbackDummy *callback, iint32 priority) const;
+
+    /**
+      * Marks @p callback as disconnected without compacting the snapshot.
+      *
+      * @return Whether @p callback was connected.
+      */
+    bool disconnectCallback(CallbackDummy *callback) const;
+
+    /**
+      * Publishes a snapshot without disconnected callbacks if they are half of the current one.
+      * Gives up if another thread publishes a snapshot meanwhile, as it drops them as well.
+      */
+    void compactConnections() const;
+
+    /**
+      * Marks all callbacks as disconnected and publishes an empty snapshot, which is 0 unless a
+      * thread pool or static slots were set. Static slots are kept.
+      */
+    void removeAllConnections() const;
+
+    /**
+      * @return @p connections with its forwards to other signals replaced by the callbacks of those
+      *         signals, recursively, so a chain of forwards is delivered in one pass. The result is
+      *         cached on @p connections until some link of the chain changes. Forwards to signals
+      *         whose parent has emit() blocked are dropped. Its links tell which callbacks each
+      *         forwarded signal contributed, so emissions can still give those signals their own
+      *         EmitFrame, trace and metrics. Has to be called with an Epoch::Guard, which also keeps
+      *         the result alive.
+      */
+    static const ConnectionList *flattenedConnections(const ConnectionList *connections);
+
+    /**
+      * @return Whether no link of the chain @p flattened was built from changed since.
+      */
+    static bool isFlattenedValid(const ConnectionList *flattened);
+
+    /**
+      * Writes the callbacks @p connections ends up calling to @p callbacks, up to @p capacity of
+      * them, and the forwards walked to @p links, up to @p linkCapacity of them. The number of
+      * forwards walked is added to @p linkCount. @p offset is the index of @p callbacks in the
+      * flattened list.
+      *
+      * @return The number of callbacks @p connections ends up calling.
+      */
+    static size_t flatten(const ConnectionList *connections, CallbackDummy **callbacks, size_t capacity, size_t offset,
+                          ConnectionList::ForwardLink *links, size_t linkCapacity, size_t &linkCount, size_t depth);
+
+    typedef void (*Invoke)(CallbackDummy *callback, const void *param);
+
+    /**
+      * Calls @p invoke with each connected callback and @p param from the workers of the thread pool
+      * of this signal and the calling thread, and returns when all calls returned.
+      * If @p ordered is true, all callbacks of the same receiver are called from the same thread,
+      * in the order they were connected.
+      */
+    void emitOnThreadPool(Invoke invoke, const void *param, bool ordered) const;
+
+    /**
+      * Calls @p invoke with @p callback and @p param, recording the call in the metrics and in the
+      * trace when they are enabled.
+      */
+    static void invokeRecorded(Invoke invoke, CallbackDummy *callback, const void *param, const ichar *signalName);
+
+#ifdef IDEAL_SIGNAL_METRICS
+    void recordEmit(iuint64 latency) const
+    {
+        m_metrics->m_latency.record(latency);
+    }
+
+    /**
+      * Records an emission of @p signal, which another signal reached through a flattened forward.
+      */
+    static void recordEmit(const SignalBase *signal, iuint64 latency)
+    {
+        signal->recordEmit(latency);
+    }
+
+    /**
+      * The slot metrics belong to @p callback, so they can be written even if the call destroyed
+      * the signal whose metrics hold them.
+      */
+    static void recordCall(CallbackDummy *callback, iuint64 latency)
+    {
+        callback->m_metrics->m_latency.record(latency);
+    }
+#endif
+
+    SignalResource                       * const m_parent;
+    const bool                                   m_isDestroyedSignal;
+    const ichar                          * const m_name;
+    // 0 until the first connection
+    mutable std::atomic<ConnectionList*>         m_connections;
+#ifdef IDEAL_SIGNAL_METRICS
+    SignalMetrics::Record                * const m_metrics;
+#endif
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -506,120 +1166,191 @@ public:
 
     virtual ~Signal()
     {
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            delete *it;
-        }
-        m_connections.clear();
     }
 
     virtual void disconnect(SignalResource *receiver) const
     {
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end();) {
-            const CallbackDummy *const curr = *it;
-            if (curr->m_receiver == static_cast<void*>(receiver)) {
+        Epoch::Guard guard;
+        const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+        for (size_t i = 0; connections && i < connections->m_count; ++i) {
+            CallbackDummy *const curr = connections->m_callbacks[i];
+            if (curr->m_receiver == static_cast<void*>(receiver) && disconnectCallback(curr)) {
                 notifyReceiverDisconnection(receiver, this);
-                it = m_connections.erase(it);
-                delete curr;
-                continue;
             }
-            ++it;
         }
+        compactConnections();
     }
 
     template <typename Receiver, typename Member>
-    void connect(Receiver *receiver, Member member) const
+    Connection connect(Receiver *receiver, Member member) const
     {
         if (!receiver) {
             IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
-            return;
+            return Connection();
         }
         notifyReceiverConnection(receiver, this);
         CallbackBase<Param...> *callback = CallbackBase<Param...>::make(receiver, member);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        addConnection(callback);
+        return Connection(this, callback);
     }
 
     template <typename Receiver, typename Member>
-    void connectSynchronized(Receiver *receiver, Member member, Mutex &mutex) const
+    Connection connectSynchronized(Receiver *receiver, Member member, Mutex &mutex) const
     {
         if (!receiver) {
             IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
-            return;
+            return Connection();
         }
         notifyReceiverConnection(receiver, this);
         CallbackBase<Param...> *callback = CallbackBase<Param...>::makeSynchronized(receiver, member, mutex);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        addConnection(callback);
+        return Connection(this, callback);
     }
 
     template <typename Receiver, typename Member>
-    void connectMulti(Receiver *receiver, Member member) const
+    Connection connectMulti(Receiver *receiver, Member member) const
     {
         if (!receiver) {
             IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
-            return;
+            return Connection();
         }
         notifyReceiverConnection(receiver, this);
         CallbackBase<Param...> *callback = CallbackBase<Param...>::makeMulti(m_parent, receiver, member);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        addConnection(callback);
+        return Connection(this, callback);
     }
 
     template <typename Receiver, typename Member>
-    void connectMultiSynchronized(Receiver *receiver, Member member, Mutex &mutex) const
+    Connection connectMultiSynchronized(Receiver *receiver, Member member, Mutex &mutex) const
     {
         if (!receiver) {
             IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
-            return;
+            return Connection();
         }
         notifyReceiverConnection(receiver, this);
         CallbackBase<Param...> *callback = CallbackBase<Param...>::makeMultiSynchronized(m_parent, receiver, member, mutex);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        addConnection(callback);
+        return Connection(this, callback);
+    }
+
+    /**
+      * Connects @p member of @p receiver so that it is called on the thread running @p eventLoop.
+      * Each emission copies its arguments and posts them to @p eventLoop without blocking.
+      * @p deliveryPolicy can drop emissions that are not needed, such as all but the newest one.
+      *
+      * @note @p receiver has to be disconnected before it is destroyed, and from the thread running
+      *       @p eventLoop if emissions can still be pending.
+      *
+      * @note core/event_loop.h has to be included.
+      */
+    template <typename Receiver, typename Member>
+    Connection connectQueued(Receiver *receiver, Member member, EventLoop &eventLoop,
+                             const DeliveryPolicy &deliveryPolicy = DeliveryPolicy()) const
+    {
+        if (!receiver) {
+            IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
+            return Connection();
+        }
+        notifyReceiverConnection(receiver, this);
+        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeQueued(receiver, member, eventLoop, deliveryPolicy, m_name);
+        addConnection(callback);
+        return Connection(this, callback);
+    }
+
+    /**
+      * Connects @p channel, so each emission sends its arguments to the process receiving from
+      * @p channel, where SharedMemoryChannel::forward() emits them again. Emitting never blocks:
+      * emissions are dropped while @p channel is full.
+      *
+      * @note All parameters of this signal have to be trivially copyable, and @p channel has to
+      *       be destroyed after disconnecting it.
+      *
+      * @note core/shared_memory_channel.h has to be included.
+      */
+    Connection connectShared(SharedMemoryChannel &channel) const
+    {
+        static_assert(AreTriviallyCopyable<Param...>::value, "only trivially copyable parameters can be shared");
+        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeShared(channel);
+        addConnection(callback);
+        return Connection(this, callback);
+    }
+
+    /**
+      * Connects @p functor, any object that can be called with the parameters of this signal, such
+      * as a lambda. A copy of @p functor is stored inside the connection.
+      *
+      * @code
+      * myObject->valueChanged.connect([this](const iint32 &value) { m_value = value; });
+      * @endcode
+      *
+      * @note The connection can only be removed through the returned Connection, or by disconnecting
+      *       all connections of this signal.
+      */
+    template <typename Functor,
+              typename = typename std::enable_if<!std::is_base_of<SignalBase, Functor>::value>::type>
+    Connection connect(const Functor &functor) const
+    {
+        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeFunctor(functor);
+        addConnection(callback);
+        return Connection(this, callback);
+    }
+
+    /**
+      * Connects @p member of @p receiver, which takes all the arguments of an emitBatch() at once as
+      * a const Vector<std::tuple<Param...> >&, so it can process them in bulk. Each emit() calls it
+      * with a batch of one element.
+      */
+    template <typename Receiver, typename Member>
+    Connection connectBatch(Receiver *receiver, Member member) const
+    {
+        if (!receiver) {
+            IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
+            return Connection();
+        }
+        notifyReceiverConnection(receiver, this);
+        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeBatch(receiver, member);
+        addConnection(callback);
+        return Connection(this, callback);
     }
 
-    void connect(const Signal<Param...> &signal) const
+    Connection connect(const Signal<Param...> &signal) const
     {
         notifyReceiverConnection(signal.parent(), this);
         CallbackBase<Param...> *signalForward = CallbackBase<Param...>::makeForward(signal);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(signalForward);
+        addConnection(signalForward);
+        return Connection(this, signalForward);
     }
 
     template <typename Member>
-    void connectStatic(Member member) const
+    Connection connectStatic(Member member) const
     {
         CallbackBase<Param...> *callback = CallbackBase<Param...>::makeStatic(member);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        addConnection(callback);
+        return Connection(this, callback);
     }
 
     template <typename Member>
-    void connectStaticSynchronized(Member member, Mutex &mutex) const
+    Connection connectStaticSynchronized(Member member, Mutex &mutex) const
     {
         CallbackBase<Param...> *callback = CallbackBase<Param...>::makeStaticSynchronized(member, mutex);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        addConnection(callback);
+        return Connection(this, callback);
     }
 
     template <typename Member>
-    void connectStaticMulti(Member member) const
+    Connection connectStaticMulti(Member member) const
     {
         CallbackBase<Param...> *callback = CallbackBase<Param...>::makeStaticMulti(m_parent, member);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        addConnection(callback);
+        return Connection(this, callback);
     }
 
     template <typename Member>
-    void connectStaticMultiSynchronized(Member member, Mutex &mutex) const
+    Connection connectStaticMultiSynchronized(Member member, Mutex &mutex) const
     {
         CallbackBase<Param...> *callback = CallbackBase<Param...>::makeStaticMultiSynchronized(m_parent, member, mutex);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        addConnection(callback);
+        return Connection(this, callback);
     }
 
     template <typename Receiver, typename Member>
@@ -630,13 +1361,12 @@ public:
             return;
         }
         notifyReceiverDisconnection(receiver, this);
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            Callback<Receiver, Member, Param...> *const curr = dynamic_cast<Callback<Receiver, Member, Param...>*>(*it);
-            if (curr && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member) {
-                m_connections.erase(it);
-                delete curr;
+        Epoch::Guard guard;
+        const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+        for (size_t i = 0; connections && i < connections->m_count; ++i) {
+            Callback<Receiver, Member, Param...> *const curr = dynamic_cast<Callback<Receiver, Member, Param...>*>(connections->m_callbacks[i]);
+            if (curr && !curr->isDisconnected() && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member) {
+                removeConnection(curr);
                 return;
             }
         }
@@ -651,13 +1381,12 @@ public:
             return;
         }
         notifyReceiverDisconnection(receiver, this);
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            CallbackSynchronized<Receiver, Member, Param...> *const curr = dynamic_cast<CallbackSynchronized<Receiver, Member, Param...>*>(*it);
-            if (curr && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member && curr->m_mutex == mutex) {
-                m_connections.erase(it);
-                delete curr;
+        Epoch::Guard guard;
+        const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+        for (size_t i = 0; connections && i < connections->m_count; ++i) {
+            CallbackSynchronized<Receiver, Member, Param...> *const curr = dynamic_cast<CallbackSynchronized<Receiver, Member, Param...>*>(connections->m_callbacks[i]);
+            if (curr && !curr->isDisconnected() && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member && curr->m_mutex == mutex) {
+                removeConnection(curr);
                 return;
             }
         }
@@ -672,13 +1401,12 @@ public:
             return;
         }
         notifyReceiverDisconnection(receiver, this);
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            CallbackMulti<Receiver, Member, Param...> *const curr = dynamic_cast<CallbackMulti<Receiver, Member, Param...>*>(*it);
-            if (curr && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member) {
-                m_connections.erase(it);
-                delete curr;
+        Epoch::Guard guard;
+        const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+        for (size_t i = 0; connections && i < connections->m_count; ++i) {
+            CallbackMulti<Receiver, Member, Param...> *const curr = dynamic_cast<CallbackMulti<Receiver, Member, Param...>*>(connections->m_callbacks[i]);
+            if (curr && !curr->isDisconnected() && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member) {
+                removeConnection(curr);
                 return;
             }
         }
@@ -693,13 +1421,12 @@ public:
             return;
         }
         notifyReceiverDisconnection(receiver, this);
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            CallbackMultiSynchronized<Receiver, Member, Param...> *const curr = dynamic_cast<CallbackMultiSynchronized<Receiver, Member, Param...>*>(*it);
-            if (curr && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member && curr->m_mutex == mutex) {
-                m_connections.erase(it);
-                delete curr;
+        Epoch::Guard guard;
+        const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+        for (size_t i = 0; connections && i < connections->m_count; ++i) {
+            CallbackMultiSynchronized<Receiver, Member, Param...> *const curr = dynamic_cast<CallbackMultiSynchronized<Receiver, Member, Param...>*>(connections->m_callbacks[i]);
+            if (curr && !curr->isDisconnected() && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member && curr->m_mutex == mutex) {
+                removeConnection(curr);
                 return;
             }
         }
@@ -711,13 +1438,12 @@ public:
     template <typename Member>
     void disconnectStatic(Member member) const
     {
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            CallbackStatic<Member, Param...> *const curr = dynamic_cast<CallbackStatic<Member, Param...>*>(*it);
-            if (curr && curr->m_member == member) {
-                m_connections.erase(it);
-                delete curr;
+        Epoch::Guard guard;
+        const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+        for (size_t i = 0; connections && i < connections->m_count; ++i) {
+            CallbackStatic<Member, Param...> *const curr = dynamic_cast<CallbackStatic<Member, Param...>*>(connections->m_callbacks[i]);
+            if (curr && !curr->isDisconnected() && curr->m_member == member) {
+                removeConnection(curr);
                 return;
             }
         }
@@ -727,13 +1453,12 @@ public:
     template <typename Member>
     void disconnectStaticSynchronized(Member member, Mutex &mutex) const
     {
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            CallbackStaticSynchronized<Member, Param...> *const curr = dynamic_cast<CallbackStaticSynchronized<Member, Param...>*>(*it);
-            if (curr && curr->m_member == member && curr->m_mutex == mutex) {
-                m_connections.erase(it);
-                delete curr;
+        Epoch::Guard guard;
+        const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+        for (size_t i = 0; connections && i < connections->m_count; ++i) {
+            CallbackStaticSynchronized<Member, Param...> *const curr = dynamic_cast<CallbackStaticSynchronized<Member, Param...>*>(connections->m_callbacks[i]);
+            if (curr && !curr->isDisconnected() && curr->m_member == member && curr->m_mutex == mutex) {
+                removeConnection(curr);
                 return;
             }
         }
@@ -743,13 +1468,12 @@ public:
     template <typename Member>
     void disconnectStaticMulti(Member member) const
     {
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            CallbackStaticMulti<Member, Param...> *const curr = dynamic_cast<CallbackStaticMulti<Member, Param...>*>(*it);
-            if (curr && curr->m_member == member) {
-                m_connections.erase(it);
-                delete curr;
+        Epoch::Guard guard;
+        const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+        for (size_t i = 0; connections && i < connections->m_count; ++i) {
+            CallbackStaticMulti<Member, Param...> *const curr = dynamic_cast<CallbackStaticMulti<Member, Param...>*>(connections->m_callbacks[i]);
+            if (curr && !curr->isDisconnected() && curr->m_member == member) {
+                removeConnection(curr);
                 return;
             }
         }
@@ -759,13 +1483,12 @@ public:
     template <typename Member>
     void disconnectStaticMultiSynchronized(Member member, Mutex &mutex) const
     {
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            CallbackStaticMultiSynchronized<Member, Param...> *const curr = dynamic_cast<CallbackStaticMultiSynchronized<Member, Param...>*>(*it);
-            if (curr && curr->m_member == member && curr->m_mutex == mutex) {
-                m_connections.erase(it);
-                delete curr;
+        Epoch::Guard guard;
+        const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+        for (size_t i = 0; connections && i < connections->m_count; ++i) {
+            CallbackStaticMultiSynchronized<Member, Param...> *const curr = dynamic_cast<CallbackStaticMultiSynchronized<Member, Param...>*>(connections->m_callbacks[i]);
+            if (curr && !curr->isDisconnected() && curr->m_member == member && curr->m_mutex == mutex) {
+                removeConnection(curr);
                 return;
             }
         }
@@ -774,34 +1497,307 @@ public:
 
     void emit(const Param&... param) const
     {
-        if (m_parent->isEmitBlocked() && !m_isDestroyedSignal) {
+        callSlots<false, StaticSlotList<> >(param...);
+    }
+
+    /**
+      * Emits this signal, stopping at the first slot that handles it: one returning a bool that
+      * returns true. Slots are called by decreasing priority (see Connection::setPriority()), so
+      * the ones with higher priority get the chance to handle it first.
+      *
+      * @return Whether a slot handled the emission.
+      */
+    bool emitUntilHandled(const Param&... param) const
+    {
+        return callSlots<true, StaticSlotList<> >(param...);
+    }
+
+    /**
+      * Emits this signal once for each element of @p batch, taking a single snapshot of the
+      * connections for all of them. Each slot is called with every element of @p batch before the
+      * next slot is called, and slots connected with connectBatch() are called once with all of it.
+      * The metrics count it as one emission for each element.
+      */
+    void emitBatch(const Vector<std::tuple<Param...> > &batch) const
+    {
+        if (!m_connections.load(std::memory_order_relaxed)) {
             return;
         }
-        {
-            ContextMutexLocker cml(m_beingEmittedMutex);
-            m_beingEmitted = true;
+        if (m_parent->isEmitBlocked() && !m_isDestroyedSignal) {
+            return;
         }
-        List<CallbackDummy*> connections;
-        {
-            ContextMutexLocker cml(m_connectionsMutex);
-            connections = m_connections;
-        }
-        List<CallbackDummy*>::const_iterator it;
-        for (it = connections.begin(); it != connections.end(); ++it) {
-            CallbackBase<Param...> *callbackBase = static_cast<CallbackBase<Param...>*>(*it);
-            (*callbackBase)(param...);
-            List<SignalBase*>::iterator it;
-            ContextMutexLocker cml(deletedSignalsOnEmitMutex);
-            for (it = deletedSignalsOnEmit.begin(); it != deletedSignalsOnEmit.end(); ++it) {
-                if (*it == this) {
-                    deletedSignalsOnEmit.erase(it);
+        EmitFrame emitFrame(this);
+        const ichar *const name = m_name;
+        const bool tracing = SignalTrace::isEnabled();
+        const iuint64 traceStart = tracing ? SignalTrace::now() : 0;
+#ifdef IDEAL_SIGNAL_METRICS
+        const iuint64 emitStart = SignalMetrics::now();
+        iuint64 time = emitStart;
+#endif
+        Epoch::Guard guard;
+        const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+        const size_t count = connections ? connections->m_count : 0;
+        const size_t batchSize = batch.size();
+        CallbackDummy *const staticSlots = connections ? connections->m_staticSlots : 0;
+        for (size_t i = staticSlots ? 0 : 1; i <= count; ++i) {
+            CallbackDummy *const callback = i ? connections->m_callbacks[i - 1] : staticSlots;
+            if (callback->isDisconnected()) {
+                continue;
+            }
+            SignalResource *const receiver = callback->m_receiver;
+            iuint64 callStart = IDEAL_UNLIKELY(tracing) ? SignalTrace::now() : 0;
+            if (static_cast<CallbackBase<Param...>*>(callback)->callBatch(batch)) {
+                if (emitFrame.m_destroyed) {
+                    return;
+                }
+                if (IDEAL_UNLIKELY(tracing)) {
+                    SignalTrace::record(SignalTrace::Call, name, receiver, callStart);
+                }
+#ifdef IDEAL_SIGNAL_METRICS
+                const iuint64 callEnd = SignalMetrics::now();
+                recordCall(callback, callEnd - time);
+                time = callEnd;
+#endif
+                continue;
+            }
+            // The slot can disconnect itself in the middle of the batch
+            for (size_t j = 0; j < batchSize && !callback->isDisconnected(); ++j) {
+                if (IDEAL_UNLIKELY(tracing)) {
+                    callStart = SignalTrace::now();
+                }
+                invokeCallback(callback, batch[j], typename MakeIndexList<sizeof...(Param)>::Type());
+                if (emitFrame.m_destroyed) {
                     return;
                 }
+                if (IDEAL_UNLIKELY(tracing)) {
+                    SignalTrace::record(SignalTrace::Call, name, receiver, callStart);
+                }
+#ifdef IDEAL_SIGNAL_METRICS
+                const iuint64 callEnd = SignalMetrics::now();
+                recordCall(callback, callEnd - time);
+                time = callEnd;
+#endif
             }
         }
-        {
-            ContextMutexLocker cml(m_beingEmittedMutex);
-            m_beingEmitted = false;
+#ifdef IDEAL_SIGNAL_METRICS
+        // A batch counts as one emission for each of its elements, sharing its latency
+        for (size_t j = 0; j < batchSize; ++j) {
+            recordEmit((time - emitStart) / batchSize);
+        }
+#endif
+        if (IDEAL_UNLIKELY(traceStart)) {
+            SignalTrace::record(SignalTrace::Emission, name, m_parent, traceStart);
+        }
+    }
+
+    /**
+      * Like emit(), but the slots are called in parallel from the workers of the thread pool of this
+      * signal (see setThreadPool()) and the calling thread. Returns when all slots returned. Slots of
+      * the same receiver can run concurrently.
+      *
+      * @note Slots must not destroy this signal.
+      */
+    void emitParallel(const Param&... param) const
+    {
+        const std::tuple<const Param&...> packedParam(param...);
+        emitOnThreadPool(&invokeCallback, &packedParam, false);
+    }
+
+    /**
+      * Like emitParallel(), but slots of the same receiver are called from the same thread, in the
+      * order they were connected. Slots of different receivers still run in parallel.
+      *
+      * @note Slots must not destroy this signal.
+      */
+    void emitParallelOrdered(const Param&... param) const
+    {
+        const std::tuple<const Param&...> packedParam(param...);
+        emitOnThreadPool(&invokeCallback, &packedParam, true);
+    }
+
+protected:
+    /**
+      * Calls the slots of an emission. If @p UntilHandled is true, stops at the first slot that
+      * handles it. @p Slots are the static slots of a StaticSignal, which are called directly
+      * instead of through the callback the list holds for them. When there are no connected
+      * callbacks, nothing else is called.
+      *
+      * @return Whether a slot handled the emission.
+      */
+    template <bool UntilHandled, typename Slots>
+    bool callSlots(const Param&... param) const
+    {
+        // Nothing to set up for signals without connections. Those emissions are neither traced
+        // nor recorded in the metrics
+        if (!m_connections.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (m_parent->isEmitBlocked() && !m_isDestroyedSignal) {
+            return false;
+        }
+        EmitFrame emitFrame(this);
+        // Slot calls are recorded after they return, when this signal could have been destroyed
+        const ichar *const name = m_name;
+        const bool tracing = SignalTrace::isEnabled();
+        const iuint64 traceStart = tracing ? SignalTrace::now() : 0;
+#ifdef IDEAL_SIGNAL_METRICS
+        // The end of each slot call is the start of the next one, so the clock is read once per slot
+        const iuint64 emitStart = SignalMetrics::now();
+        iuint64 time = emitStart;
+#endif
+        // Snapshots replaced by connect() or disconnect() are not freed while the guard exists, so
+        // the snapshot we load here stays valid until we are done with it
+        Epoch::Guard guard;
+        const ConnectionList *connections = m_connections.load(std::memory_order_seq_cst);
+        // Static slots go first, and connected callbacks follow. A StaticSignal calls them directly
+        // from here, other emissions through the callback at index 0
+        CallbackDummy *const staticSlots = connections ? connections->m_staticSlots : 0;
+        bool handled = false;
+        size_t first = staticSlots ? 0 : 1;
+        if (!std::is_same<Slots, StaticSlotList<> >::value) {
+            if (!m_parent->areSignalsBlocked()) {
+                const iuint64 callStart = IDEAL_UNLIKELY(tracing) ? SignalTrace::now() : 0;
+                if (UntilHandled) {
+                    handled = Slots::callHandled(m_parent, param...);
+                } else {
+                    Slots::call(m_parent, param...);
+                }
+                if (emitFrame.m_destroyed) {
+                    return handled;
+                }
+                if (IDEAL_UNLIKELY(tracing)) {
+                    SignalTrace::record(SignalTrace::Call, name, m_parent, callStart);
+                }
+#ifdef IDEAL_SIGNAL_METRICS
+                const iuint64 callEnd = SignalMetrics::now();
+                recordCall(staticSlots, callEnd - time);
+                time = callEnd;
+#endif
+            }
+            first = 1;
+        }
+        // Forwards are replaced by the callbacks they end up calling, which follow the static slots
+        const ConnectionList *flattened = 0;
+        if (connections && IDEAL_UNLIKELY(connections->m_hasForwards)) {
+            flattened = flattenedConnections(connections);
+        }
+        const size_t count = connections && !flattened && !(UntilHandled && handled) ? connections->m_count : 0;
+        for (size_t i = first; i <= count; ++i) {
+            CallbackDummy *const callback = i ? connections->m_callbacks[i - 1] : staticSlots;
+            if (callback->isDisconnected()) {
+                continue;
+            }
+            if (IDEAL_UNLIKELY(tracing)) {
+                SignalResource *const receiver = callback->m_receiver;
+                const iuint64 callStart = SignalTrace::now();
+                handled = callSlot<UntilHandled>(callback, param...);
+                SignalTrace::record(SignalTrace::Call, name, receiver, callStart);
+            } else {
+                handled = callSlot<UntilHandled>(callback, param...);
+            }
+            if (emitFrame.m_destroyed) {
+                return handled;
+            }
+#ifdef IDEAL_SIGNAL_METRICS
+            const iuint64 callEnd = SignalMetrics::now();
+            recordCall(callback, callEnd - time);
+            time = callEnd;
+#endif
+            if (UntilHandled && handled) {
+                break;
+            }
+        }
+        if (IDEAL_UNLIKELY(flattened != 0) && !(UntilHandled && handled)) {
+            size_t index = 0;
+            size_t link = 0;
+            callFlattened<UntilHandled>(flattened, index, flattened->m_count, link, flattened->m_linkCount, emitFrame,
+                                        name, tracing, handled, param...);
+            if (emitFrame.m_destroyed) {
+                return handled;
+            }
+#ifdef IDEAL_SIGNAL_METRICS
+            time = SignalMetrics::now();
+#endif
+        }
+#ifdef IDEAL_SIGNAL_METRICS
+        recordEmit(time - emitStart);
+#endif
+        if (IDEAL_UNLIKELY(tracing)) {
+            SignalTrace::record(SignalTrace::Emission, name, m_parent, traceStart);
+        }
+        return handled;
+    }
+
+    /**
+      * Calls the callbacks of @p flattened from @p index up to @p end, and walks its links from
+      * @p link up to @p linkEnd, as the emission of @p frame. Each forwarded signal gets its own
+      * EmitFrame, trace and metrics for the callbacks reached through it, as if the forward had
+      * emitted it, and the rest of them are skipped if a slot destroys it. Returns early if
+      * @p frame is destroyed or, if @p UntilHandled is true, when a slot handles the emission.
+      */
+    template <bool UntilHandled>
+    static void callFlattened(const ConnectionList *flattened, size_t &index, size_t end, size_t &link,
+                              size_t linkEnd, const EmitFrame &frame, const ichar *name, bool tracing,
+                              bool &handled, const Param&... param)
+    {
+        const ConnectionList::ForwardLink *const links = flattened->m_links;
+        while (index < end || link < linkEnd) {
+            if (link < linkEnd && links[link].begin == index) {
+                const ConnectionList::ForwardLink &forward = links[link++];
+                // The signal is only accessed while the forward to it is connected
+                if (forward.emitBlocked || forward.forward->isDisconnected() || !forward.connections) {
+                    index = forward.end;
+                    link = forward.linkEnd;
+                    continue;
+                }
+                const SignalBase *const signal = forward.signal;
+                const ichar *const signalName = signal->name();
+                const iuint64 traceStart = IDEAL_UNLIKELY(tracing) ? SignalTrace::now() : 0;
+#ifdef IDEAL_SIGNAL_METRICS
+                const iuint64 emitStart = SignalMetrics::now();
+#endif
+                EmitFrame signalFrame(signal);
+                callFlattened<UntilHandled>(flattened, index, forward.end, link, forward.linkEnd, signalFrame,
+                                            signalName, tracing, handled, param...);
+                if (signalFrame.m_destroyed) {
+                    index = forward.end;
+                    link = forward.linkEnd;
+                } else {
+#ifdef IDEAL_SIGNAL_METRICS
+                    recordEmit(signal, SignalMetrics::now() - emitStart);
+#endif
+                    if (IDEAL_UNLIKELY(tracing)) {
+                        SignalTrace::record(SignalTrace::Emission, signalName, signal->parent(), traceStart);
+                    }
+                }
+                if (frame.m_destroyed || (UntilHandled && handled)) {
+                    return;
+                }
+                continue;
+            }
+            CallbackDummy *const callback = flattened->m_callbacks[index++];
+            if (callback->isDisconnected()) {
+                continue;
+            }
+            SignalResource *const receiver = callback->m_receiver;
+#ifdef IDEAL_SIGNAL_METRICS
+            const iuint64 callStart = SignalMetrics::now();
+#else
+            const iuint64 callStart = IDEAL_UNLIKELY(tracing) ? SignalTrace::now() : 0;
+#endif
+            handled = callSlot<UntilHandled>(callback, param...);
+            if (frame.m_destroyed) {
+                return;
+            }
+            if (IDEAL_UNLIKELY(tracing)) {
+                SignalTrace::record(SignalTrace::Call, name, receiver, callStart);
+            }
+#ifdef IDEAL_SIGNAL_METRICS
+            recordCall(callback, SignalMetrics::now() - callStart);
+#endif
+            if (UntilHandled && handled) {
+                return;
+            }
         }
     }
 
@@ -810,6 +1806,29 @@ private:
         : SignalBase(parent)
     {
     }
+
+    template <bool UntilHandled>
+    static bool callSlot(CallbackDummy *callback, const Param&... param)
+    {
+        CallbackBase<Param...> *const slot = static_cast<CallbackBase<Param...>*>(callback);
+        if (UntilHandled) {
+            return slot->callHandled(param...);
+        }
+        (*slot)(param...);
+        return false;
+    }
+
+    static void invokeCallback(CallbackDummy *callback, const void *param)
+    {
+        invokeCallback(callback, *static_cast<const std::tuple<const Param&...>*>(param),
+                       typename MakeIndexList<sizeof...(Param)>::Type());
+    }
+
+    template <typename Tuple, size_t... Index>
+    static void invokeCallback(CallbackDummy *callback, const Tuple &param, IndexList<Index...>)
+    {
+        (*static_cast<CallbackBase<Param...>*>(callback))(std::get<Index>(param)...);
+    }
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -833,6 +1852,22 @@ public:
         m_signal->emit(param...);
     }
 
+    virtual bool callBatch(const Vector<std::tuple<Param...> > &batch)
+    {
+        m_signal->emitBatch(batch);
+        return true;
+    }
+
+    virtual bool callHandled(const Param&... param)
+    {
+        return m_signal->emitUntilHandled(param...);
+    }
+
+    virtual const SignalBase *forwardedSignal() const
+    {
+        return m_signal;
+    }
+
     Signal<Param...> *m_signal;
 };
 
@@ -857,13 +1892,12 @@ template <typename... Param>
 void Signal<Param...>::disconnect(const Signal<Param...> &signal) const
 {
     notifyReceiverDisconnection(signal.parent(), this);
-    List<CallbackDummy*>::iterator it;
-    ContextMutexLocker cml(m_connectionsMutex);
-    for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-        SignalCallback<Param...> *const curr = dynamic_cast<SignalCallback<Param...>*>(*it);
-        if (curr && curr->m_signal == &signal) {
-            m_connections.erase(it);
-            delete curr;
+    Epoch::Guard guard;
+    const ConnectionList *const connections = m_connections.load(std::memory_order_seq_cst);
+    for (size_t i = 0; connections && i < connections->m_count; ++i) {
+        SignalCallback<Param...> *const curr = dynamic_cast<SignalCallback<Param...>*>(connections->m_callbacks[i]);
+        if (curr && !curr->isDisconnected() && curr->m_signal == &signal) {
+            removeConnection(curr);
             return;
         }
     }
@@ -22,6 +22,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
 
 namespace IdealCore {
 
@@ -55,7 +56,8 @@ public:
     bool    m_sizeCalculated;
     size_t  m_rawLen;
     bool    m_rawLenCalculated;
-    size_t  m_refs;
+
+    std::atomic<size_t> m_refs;
 
     class PrivateEmpty;
     static Private *m_privateEmpty;
@@ -105,21 +107,17 @@ String::Private *String::Private::copy()
 
 void String::Private::copyAndDetach(String *str)
 {
-    if (m_refs > 1) {
+    if (m_refs.load(std::memory_order_acquire) > 1) {
         str->d = copy();
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     }
 }
 
 void String::Private::newAndDetach(String *str)
 {
-    if (m_refs > 1) {
+    if (m_refs.load(std::memory_order_acquire) > 1) {
         str->d = new Private;
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     } else {
         clearContents();
     }
@@ -139,16 +137,12 @@ void String::Private::clearContents()
 
 void String::Private::ref()
 {
-    ++m_refs;
+    m_refs.fetch_add(1, std::memory_order_relaxed);
 }
 
 void String::Private::deref()
 {
-    --m_refs;
-    if (!m_refs) {
-        if (this == m_privateEmpty) {
-            m_privateEmpty = 0;
-        }
+    if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
         delete this;
     }
 }
@@ -291,12 +285,9 @@ public:
 
 String::Private *String::Private::empty()
 {
-    if (!m_privateEmpty) {
-        m_privateEmpty = new PrivateEmpty;
-    } else {
-        m_privateEmpty->ref();
-    }
-    return m_privateEmpty;
+    static Private *const privateEmpty = m_privateEmpty = new PrivateEmpty;
+    privateEmpty->ref();
+    return privateEmpty;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,467 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "private/idna_p.h"
+
+#include <string.h>
+#include <strings.h>
+
+namespace IdealCore {
+
+// Punycode parameters for IDNA (RFC 3492, 5)
+static const iuint32 punycodeBase = 36;
+static const iuint32 punycodeTMin = 1;
+static const iuint32 punycodeTMax = 26;
+static const iuint32 punycodeSkew = 38;
+static const iuint32 punycodeDamp = 700;
+static const iuint32 punycodeInitialBias = 72;
+static const iuint32 punycodeInitialN = 128;
+
+static const size_t maxLabelLength = 63;
+
+static iuint32 adaptBias(iuint32 delta, iuint32 numPoints, bool firstTime)
+{
+    delta = firstTime ? delta / punycodeDamp : delta / 2;
+    delta += delta / numPoints;
+    iuint32 k = 0;
+    while (delta > ((punycodeBase - punycodeTMin) * punycodeTMax) / 2) {
+        delta /= punycodeBase - punycodeTMin;
+        k += punycodeBase;
+    }
+    return k + (punycodeBase - punycodeTMin + 1) * delta / (delta + punycodeSkew);
+}
+
+static inline iuint32 threshold(iuint32 k, iuint32 bias)
+{
+    if (k <= bias) {
+        return punycodeTMin;
+    }
+    if (k >= bias + punycodeTMax) {
+        return punycodeTMax;
+    }
+    return k - bias;
+}
+
+static inline ichar encodeDigit(iuint32 digit)
+{
+    // 0 - 25 are 'a' - 'z', 26 - 35 are '0' - '9'
+    return digit < 26 ? 'a' + digit : '0' + digit - 26;
+}
+
+static inline iuint32 decodeDigit(ichar c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 26;
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a';
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    return punycodeBase;
+}
+
+/**
+  * Applies the basic IDNA mapping to @p c.
+  *
+  * @return The mapped code point. 0 if @p c maps to nothing.
+  */
+static iuint32 mapCodePoint(iuint32 c)
+{
+    if (c < 0x80) {
+        return (c >= 'A' && c <= 'Z') ? c + 32 : c;
+    }
+    // Label separators
+    if (c == 0x3002 || c == 0xff0e || c == 0xff61) {
+        return '.';
+    }
+    // Fullwidth ASCII
+    if (c >= 0xff01 && c <= 0xff5e) {
+        return mapCodePoint(c - 0xff01 + '!');
+    }
+    // Soft hyphen and zero width space, joiners and no-break space are mapped to nothing
+    if (c == 0xad || (c >= 0x200b && c <= 0x200d) || c == 0xfeff) {
+        return 0;
+    }
+    // Latin-1 Supplement
+    if ((c >= 0xc0 && c <= 0xde) && c != 0xd7) {
+        return c + 32;
+    }
+    // Latin Extended-A: uppercase and lowercase letters alternate, but not with the same parity in
+    // all the block
+    if ((c >= 0x100 && c <= 0x137) || (c >= 0x14a && c <= 0x177)) {
+        return c | 1;
+    }
+    if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17e)) {
+        return (c & 1) ? c + 1 : c;
+    }
+    if (c == 0x178) {
+        return 0xff;
+    }
+    // Greek
+    if (c == 0x386) {
+        return 0x3ac;
+    }
+    if (c >= 0x388 && c <= 0x38a) {
+        return c + 37;
+    }
+    if (c == 0x38c) {
+        return 0x3cc;
+    }
+    if (c == 0x38e || c == 0x38f) {
+        return c + 63;
+    }
+    if (c >= 0x391 && c <= 0x3ab && c != 0x3a2) {
+        return c + 32;
+    }
+    // Cyrillic
+    if (c >= 0x400 && c <= 0x40f) {
+        return c + 80;
+    }
+    if (c >= 0x410 && c <= 0x42f) {
+        return c + 32;
+    }
+    return c;
+}
+
+/**
+  * Decodes the UTF-8 character starting at @p str and stores it in @p c.
+  *
+  * @return The number of bytes of the character. 0 if it is not valid UTF-8.
+  */
+static size_t decodeUtf8(const ichar *str, size_t size, iuint32 &c)
+{
+    const iuint8 lead = str[0];
+    size_t length;
+    iuint32 min;
+    if (lead < 0x80) {
+        c = lead;
+        return 1;
+    } else if ((lead & 0xe0) == 0xc0) {
+        length = 2;
+        min = 0x80;
+        c = lead & 0x1f;
+    } else if ((lead & 0xf0) == 0xe0) {
+        length = 3;
+        min = 0x800;
+        c = lead & 0x0f;
+    } else if ((lead & 0xf8) == 0xf0) {
+        length = 4;
+        min = 0x10000;
+        c = lead & 0x07;
+    } else {
+        return 0;
+    }
+    if (length > size) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        const iuint8 curr = str[i];
+        if ((curr & 0xc0) != 0x80) {
+            return 0;
+        }
+        c = (c << 6) | (curr & 0x3f);
+    }
+    // Overlong forms, surrogates and code points beyond Unicode are not valid
+    if (c < min || c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff)) {
+        return 0;
+    }
+    return length;
+}
+
+static size_t encodeUtf8(iuint32 c, ichar *output)
+{
+    if (c < 0x80) {
+        output[0] = c;
+        return 1;
+    }
+    if (c < 0x800) {
+        output[0] = 0xc0 | (c >> 6);
+        output[1] = 0x80 | (c & 0x3f);
+        return 2;
+    }
+    if (c < 0x10000) {
+        output[0] = 0xe0 | (c >> 12);
+        output[1] = 0x80 | ((c >> 6) & 0x3f);
+        output[2] = 0x80 | (c & 0x3f);
+        return 3;
+    }
+    output[0] = 0xf0 | (c >> 18);
+    output[1] = 0x80 | ((c >> 12) & 0x3f);
+    output[2] = 0x80 | ((c >> 6) & 0x3f);
+    output[3] = 0x80 | (c & 0x3f);
+    return 4;
+}
+
+/**
+  * Encodes the label @p label of @p size code points as "xn--" followed by its Punycode form.
+  *
+  * @return The length of the encoded label. 0 if it would be longer than @p capacity.
+  */
+static size_t encodeLabel(const iuint32 *label, size_t size, ichar *output, size_t capacity)
+{
+    size_t outputSize = 4;
+    if (capacity < outputSize) {
+        return 0;
+    }
+    memcpy(output, "xn--", 4);
+    iuint32 numBasic = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (label[i] < 0x80) {
+            if (outputSize == capacity) {
+                return 0;
+            }
+            output[outputSize++] = label[i];
+            ++numBasic;
+        }
+    }
+    if (numBasic) {
+        if (outputSize == capacity) {
+            return 0;
+        }
+        output[outputSize++] = '-';
+    }
+    iuint32 n = punycodeInitialN;
+    iuint32 delta = 0;
+    iuint32 bias = punycodeInitialBias;
+    for (iuint32 handled = numBasic; handled < size;) {
+        iuint32 m = 0xffffffff;
+        for (size_t i = 0; i < size; ++i) {
+            if (label[i] >= n && label[i] < m) {
+                m = label[i];
+            }
+        }
+        // Labels are at most 63 characters long, so delta cannot overflow here
+        delta += (m - n) * (handled + 1);
+        n = m;
+        for (size_t i = 0; i < size; ++i) {
+            if (label[i] < n) {
+                ++delta;
+                continue;
+            }
+            if (label[i] > n) {
+                continue;
+            }
+            iuint32 q = delta;
+            for (iuint32 k = punycodeBase;; k += punycodeBase) {
+                const iuint32 t = threshold(k, bias);
+                if (q < t) {
+                    break;
+                }
+                if (outputSize == capacity) {
+                    return 0;
+                }
+                output[outputSize++] = encodeDigit(t + (q - t) % (punycodeBase - t));
+                q = (q - t) / (punycodeBase - t);
+            }
+            if (outputSize == capacity) {
+                return 0;
+            }
+            output[outputSize++] = encodeDigit(q);
+            bias = adaptBias(delta, handled + 1, handled == numBasic);
+            delta = 0;
+            ++handled;
+        }
+        ++delta;
+        ++n;
+    }
+    return outputSize;
+}
+
+/**
+  * Decodes the Punycode label @p label of @p size bytes, without its "xn--" prefix, into
+  * @p output as UTF-8.
+  *
+  * @return The length of the decoded label. 0 if @p label is not valid Punycode.
+  */
+static size_t decodeLabel(const ichar *label, size_t size, ichar *output)
+{
+    iuint32 decoded[maxLabelLength];
+    iuint32 decodedSize = 0;
+    if (size > maxLabelLength) {
+        return 0;
+    }
+    size_t basicEnd = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (label[i] == '-') {
+            basicEnd = i;
+        }
+    }
+    for (size_t i = 0; i < basicEnd; ++i) {
+        if ((iuint8) label[i] >= 0x80) {
+            return 0;
+        }
+        decoded[decodedSize++] = label[i];
+    }
+    iuint32 n = punycodeInitialN;
+    iuint32 i = 0;
+    iuint32 bias = punycodeInitialBias;
+    for (size_t pos = basicEnd ? basicEnd + 1 : 0; pos < size;) {
+        const iuint32 oldI = i;
+        iuint32 w = 1;
+        for (iuint32 k = punycodeBase;; k += punycodeBase) {
+            if (pos >= size) {
+                return 0;
+            }
+            const iuint32 digit = decodeDigit(label[pos++]);
+            if (digit >= punycodeBase || digit > (0xffffffff - i) / w) {
+                return 0;
+            }
+            i += digit * w;
+            const iuint32 t = threshold(k, bias);
+            if (digit < t) {
+                break;
+            }
+            if (w > 0xffffffff / (punycodeBase - t)) {
+                return 0;
+            }
+            w *= punycodeBase - t;
+        }
+        bias = adaptBias(i - oldI, decodedSize + 1, !oldI);
+        if (i / (decodedSize + 1) > 0x10ffff - n) {
+            return 0;
+        }
+        n += i / (decodedSize + 1);
+        i %= decodedSize + 1;
+        // Basic code points are never encoded, and neither are surrogates
+        if (n < 0x80 || (n >= 0xd800 && n <= 0xdfff) || decodedSize == maxLabelLength) {
+            return 0;
+        }
+        memmove(decoded + i + 1, decoded + i, (decodedSize - i) * sizeof(iuint32));
+        decoded[i++] = n;
+        ++decodedSize;
+    }
+    size_t outputSize = 0;
+    for (size_t j = 0; j < decodedSize; ++j) {
+        outputSize += encodeUtf8(decoded[j], output + outputSize);
+    }
+    return outputSize;
+}
+
+size_t Idna::toAscii(const ichar *host, size_t size, ichar *output, size_t capacity)
+{
+    if (!capacity) {
+        return 0;
+    }
+    // Leave room for the trailing nul character
+    --capacity;
+    iuint32 label[maxLabelLength];
+    size_t labelSize = 0;
+    bool labelIsAscii = true;
+    size_t outputSize = 0;
+    for (size_t pos = 0; pos <= size;) {
+        iuint32 c = '.';
+        if (pos < size) {
+            const size_t length = decodeUtf8(host + pos, size - pos, c);
+            if (!length) {
+                return 0;
+            }
+            pos += length;
+            c = mapCodePoint(c);
+            if (!c) {
+                continue;
+            }
+        } else {
+            ++pos;
+        }
+        if (c != '.') {
+            // Even if this label is written as "xn--" and Punycode, it will take at least as many
+            // characters as code points it has
+            if (labelSize == maxLabelLength) {
+                return 0;
+            }
+            label[labelSize++] = c;
+            labelIsAscii = labelIsAscii && c < 0x80;
+            continue;
+        }
+        size_t labelLength;
+        if (labelIsAscii) {
+            if (outputSize + labelSize > capacity) {
+                return 0;
+            }
+            for (size_t i = 0; i < labelSize; ++i) {
+                output[outputSize + i] = label[i];
+            }
+            labelLength = labelSize;
+        } else {
+            const size_t labelCapacity = capacity - outputSize < maxLabelLength ? capacity - outputSize
+                                                                              : maxLabelLength;
+            labelLength = encodeLabel(label, labelSize, output + outputSize, labelCapacity);
+            if (!labelLength) {
+                return 0;
+            }
+        }
+        outputSize += labelLength;
+        if (pos <= size) {
+            if (outputSize == capacity) {
+                return 0;
+            }
+            output[outputSize++] = '.';
+        }
+        labelSize = 0;
+        labelIsAscii = true;
+    }
+    output[outputSize] = '\0';
+    return outputSize;
+}
+
+size_t Idna::toUnicode(const ichar *host, size_t size, ichar *output, size_t capacity)
+{
+    if (!capacity) {
+        return 0;
+    }
+    --capacity;
+    size_t outputSize = 0;
+    size_t labelBegin = 0;
+    while (labelBegin <= size) {
+        const ichar *const dot = (const ichar*) memchr(host + labelBegin, '.', size - labelBegin);
+        const size_t labelEnd = dot ? dot - host : size;
+        const size_t labelSize = labelEnd - labelBegin;
+        const ichar *const label = host + labelBegin;
+        size_t decodedSize = 0;
+        if (labelSize > 4 && !strncasecmp(label, "xn--", 4)) {
+            // Each Punycode character decodes into at most one code point of at most 4 bytes
+            if (outputSize + (labelSize - 4) * 4 > capacity) {
+                return 0;
+            }
+            decodedSize = decodeLabel(label + 4, labelSize - 4, output + outputSize);
+        }
+        if (!decodedSize) {
+            if (outputSize + labelSize > capacity) {
+                return 0;
+            }
+            memcpy(output + outputSize, label, labelSize);
+            decodedSize = labelSize;
+        }
+        outputSize += decodedSize;
+        if (dot) {
+            if (outputSize == capacity) {
+                return 0;
+            }
+            output[outputSize++] = '.';
+        }
+        labelBegin = labelEnd + 1;
+    }
+    output[outputSize] = '\0';
+    return outputSize;
+}
+
+}
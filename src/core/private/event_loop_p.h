@@ -0,0 +1,99 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef EVENT_LOOP_P_H
+#define EVENT_LOOP_P_H
+
+#include <core/event_loop.h>
+
+#include <atomic>
+
+namespace IdealCore {
+
+class EventLoop::Private
+{
+public:
+    Private(EventLoop *q);
+    virtual ~Private();
+
+    /**
+      * A file descriptor reported as ready by the backend.
+      */
+    struct ReadyFileDescriptor
+    {
+        iint32  fileDescriptor;
+        iuint32 events;
+    };
+
+    class DelayedEvent;
+
+    /**
+      * A timer started with startTimer(), or an event given to postDelayed() if event is not 0.
+      */
+    struct Timer
+    {
+        iuint64  deadline;
+        iuint64  id;
+        iuint32  interval;
+        bool     singleShot;
+        Event   *event;
+    };
+
+    /**
+      * The maximum number of ready file descriptors dispatched in one batch.
+      */
+    static const size_t readyBatchSize = 64;
+
+    /**
+      * Takes all posted events and returns them in the order they were posted.
+      */
+    Event *takeEvents();
+
+    size_t executeEvents();
+    size_t dispatchTimers();
+    void pushTimer(const Timer &timer);
+    void popTimer();
+
+    /**
+      * Executes posted events, waits at most @p timeout milliseconds (-1 to wait for as long as it
+      * takes) for file descriptors and timers, and dispatches them.
+      */
+    size_t iterate(iint32 timeout);
+
+    EventLoop           *const q;
+    std::atomic<Event*>        m_events;
+    std::atomic<bool>          m_quit;
+    std::atomic<bool>          m_running;
+    iint32                     m_returnCode;
+    Timer                     *m_timers;
+    size_t                     m_timerCount;
+    size_t                     m_timerCapacity;
+    iuint64                    m_nextTimerId;
+};
+
+}
+
+#if defined(IDEAL_OS_LINUX)
+#include <core/private/linux/event_loop_p.h>
+#elif defined(IDEAL_OS_POSIX)
+#include <core/private/posix/event_loop_p.h>
+#endif
+
+#endif //EVENT_LOOP_P_H
@@ -0,0 +1,68 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef IDNA_P_H
+#define IDNA_P_H
+
+#include <ideal_export.h>
+
+namespace IdealCore {
+
+/**
+  * @internal
+  *
+  * Conversion of host names between their Unicode (UTF-8) form and their ASCII compatible form,
+  * as described in RFC 5891. Labels are encoded with Punycode (RFC 3492) and prefixed with "xn--".
+  *
+  * Before encoding, the basic IDNA mapping is applied: label separators (U+3002, U+FF0E and
+  * U+FF61) become '.', fullwidth ASCII characters become ASCII, characters that IDNA maps to
+  * nothing (soft hyphen and zero width characters) are removed, and Latin, Greek and Cyrillic
+  * letters are lowercased. Characters outside those ranges are encoded as they are.
+  */
+class Idna
+{
+public:
+    /**
+      * Converts the UTF-8 host @p host of @p size bytes into its ASCII compatible form, writing at
+      * most @p capacity bytes to @p output, including the trailing nul character.
+      *
+      * @return The length of the result. 0 if @p host is not valid UTF-8, if a label would be
+      *         longer than 63 characters or if the result does not fit in @p output.
+      */
+    static size_t toAscii(const ichar *host, size_t size, ichar *output, size_t capacity);
+
+    /**
+      * Converts all "xn--" labels of @p host, of @p size bytes, back to UTF-8. Labels that are not
+      * valid Punycode are copied unchanged. The result is never longer than 4 * @p size bytes. At
+      * most @p capacity bytes are written to @p output, including the trailing nul character.
+      *
+      * @return The length of the result. 0 if the result does not fit in @p output.
+      */
+    static size_t toUnicode(const ichar *host, size_t size, ichar *output, size_t capacity);
+
+    /**
+      * The maximum length of an ASCII compatible host name (RFC 1034).
+      */
+    static const size_t maxAsciiLength = 253;
+};
+
+}
+
+#endif //IDNA_P_H
@@ -0,0 +1,95 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <core/event_loop.h>
+#include "event_loop_p.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+namespace IdealCore {
+
+EventLoop::PrivateImpl::PrivateImpl(EventLoop *q)
+    : Private(q)
+    , m_epoll(epoll_create1(EPOLL_CLOEXEC))
+    , m_wakeUpEvent(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (m_epoll == -1 || m_wakeUpEvent == -1) {
+        IDEAL_DEBUG_WARNING("could not create the epoll instance of the event loop");
+        return;
+    }
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = m_wakeUpEvent;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeUpEvent, &event);
+}
+
+EventLoop::PrivateImpl::~PrivateImpl()
+{
+    close(m_wakeUpEvent);
+    close(m_epoll);
+}
+
+void EventLoop::PrivateImpl::wakeUp()
+{
+    const iuint64 value = 1;
+    while (write(m_wakeUpEvent, &value, sizeof(value)) == -1 && errno == EINTR) {
+    }
+}
+
+void EventLoop::PrivateImpl::watch(iint32 fileDescriptor, iuint32 events)
+{
+    epoll_event event;
+    event.events = ((events & Read) ? (iuint32) EPOLLIN : 0) |
+                   ((events & Write) ? (iuint32) EPOLLOUT : 0);
+    event.data.fd = fileDescriptor;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_MOD, fileDescriptor, &event) == -1 && errno == ENOENT) {
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, fileDescriptor, &event);
+    }
+}
+
+void EventLoop::PrivateImpl::unwatch(iint32 fileDescriptor)
+{
+    epoll_event event;
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, fileDescriptor, &event);
+}
+
+size_t EventLoop::PrivateImpl::waitForEvents(iint32 timeout, ReadyFileDescriptor *ready)
+{
+    epoll_event events[readyBatchSize];
+    const iint32 count = epoll_wait(m_epoll, events, readyBatchSize, timeout);
+    size_t res = 0;
+    for (iint32 i = 0; i < count; ++i) {
+        if (events[i].data.fd == m_wakeUpEvent) {
+            iuint64 value;
+            IDEAL_POSSIBLY_UNUSED const ssize_t size = read(m_wakeUpEvent, &value, sizeof(value));
+            continue;
+        }
+        ready[res].fileDescriptor = events[i].data.fd;
+        ready[res].events = ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) ? Read : 0) |
+                            ((events[i].events & EPOLLOUT) ? Write : 0);
+        ++res;
+    }
+    return res;
+}
+
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef EVENT_LOOP_P_H_LINUX
+#define EVENT_LOOP_P_H_LINUX
+
+#include <core/private/event_loop_p.h>
+
+namespace IdealCore {
+
+class EventLoop::PrivateImpl
+    : public EventLoop::Private
+{
+public:
+    PrivateImpl(EventLoop *q);
+    virtual ~PrivateImpl();
+
+    /**
+      * Wakes up the thread waiting in waitForEvents(). Never blocks.
+      */
+    void wakeUp();
+
+    void watch(iint32 fileDescriptor, iuint32 events);
+    void unwatch(iint32 fileDescriptor);
+
+    /**
+      * Waits at most @p timeout milliseconds, or until wakeUp() is called, for watched file
+      * descriptors to be ready. Returns immediately if wakeUp() was called since the last time.
+      *
+      * @return The number of file descriptors written to @p ready, at most readyBatchSize.
+      */
+    size_t waitForEvents(iint32 timeout, ReadyFileDescriptor *ready);
+
+    iint32 m_epoll;
+    iint32 m_wakeUpEvent;
+};
+
+}
+
+#endif //EVENT_LOOP_P_H_LINUX
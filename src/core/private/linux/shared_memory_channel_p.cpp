@@ -0,0 +1,95 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <core/shared_memory_channel.h>
+#include "shared_memory_channel_p.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+
+namespace IdealCore {
+
+SharedMemoryChannel::PrivateImpl::PrivateImpl()
+    : m_event(-1)
+{
+}
+
+SharedMemoryChannel::PrivateImpl::~PrivateImpl()
+{
+    if (m_event != -1) {
+        close(m_event);
+    }
+}
+
+bool SharedMemoryChannel::PrivateImpl::create(size_t size)
+{
+    // Not backed by any file system, so it only lives while a process maps it or holds its descriptor
+    m_memory = memfd_create("ideal-shared-memory-channel", MFD_CLOEXEC);
+    if (m_memory == -1 || ftruncate(m_memory, size)) {
+        IDEAL_DEBUG_WARNING("could not create the memory of the shared memory channel");
+        return false;
+    }
+    m_event = eventfd(0, EFD_NONBLOCK);
+    if (m_event == -1) {
+        IDEAL_DEBUG_WARNING("could not create the wake up event of the shared memory channel");
+        return false;
+    }
+    return true;
+}
+
+size_t SharedMemoryChannel::PrivateImpl::descriptors(iint32 *descriptors) const
+{
+    descriptors[0] = m_memory;
+    descriptors[1] = m_event;
+    return 2;
+}
+
+bool SharedMemoryChannel::PrivateImpl::adopt(const iint32 *descriptors, size_t count)
+{
+    if (count != 2) {
+        return false;
+    }
+    m_memory = descriptors[0];
+    m_event = descriptors[1];
+    return true;
+}
+
+void SharedMemoryChannel::PrivateImpl::wakeUp()
+{
+    const iuint64 value = 1;
+    while (write(m_event, &value, sizeof(value)) == -1 && errno == EINTR) {
+    }
+}
+
+void SharedMemoryChannel::PrivateImpl::clearWakeUp()
+{
+    iuint64 value;
+    while (read(m_event, &value, sizeof(value)) == -1 && errno == EINTR) {
+    }
+}
+
+iint32 SharedMemoryChannel::PrivateImpl::fileDescriptor() const
+{
+    return m_event;
+}
+
+}
@@ -0,0 +1,120 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <core/event_loop.h>
+#include "event_loop_p.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace IdealCore {
+
+EventLoop::PrivateImpl::PrivateImpl(EventLoop *q)
+    : Private(q)
+    , m_pollFds((pollfd*) malloc(sizeof(pollfd)))
+    , m_pollFdCount(1)
+    , m_pollFdCapacity(1)
+{
+    if (pipe(m_wakeUpPipe)) {
+        IDEAL_DEBUG_WARNING("could not create the wake up pipe of the event loop");
+        m_wakeUpPipe[0] = m_wakeUpPipe[1] = -1;
+    } else {
+        for (iint32 i = 0; i < 2; ++i) {
+            fcntl(m_wakeUpPipe[i], F_SETFL, fcntl(m_wakeUpPipe[i], F_GETFL) | O_NONBLOCK);
+            fcntl(m_wakeUpPipe[i], F_SETFD, FD_CLOEXEC);
+        }
+    }
+    // The wake up pipe is always the first file descriptor polled
+    m_pollFds[0].fd = m_wakeUpPipe[0];
+    m_pollFds[0].events = POLLIN;
+    m_pollFds[0].revents = 0;
+}
+
+EventLoop::PrivateImpl::~PrivateImpl()
+{
+    close(m_wakeUpPipe[0]);
+    close(m_wakeUpPipe[1]);
+    free(m_pollFds);
+}
+
+void EventLoop::PrivateImpl::wakeUp()
+{
+    // If the pipe is full a wake up is already pending, so the write can be lost
+    const ichar byte = 0;
+    while (write(m_wakeUpPipe[1], &byte, 1) == -1 && errno == EINTR) {
+    }
+}
+
+void EventLoop::PrivateImpl::watch(iint32 fileDescriptor, iuint32 events)
+{
+    size_t i = 1;
+    while (i < m_pollFdCount && m_pollFds[i].fd != fileDescriptor) {
+        ++i;
+    }
+    if (i == m_pollFdCount) {
+        if (m_pollFdCount == m_pollFdCapacity) {
+            m_pollFdCapacity *= 2;
+            m_pollFds = (pollfd*) realloc(m_pollFds, m_pollFdCapacity * sizeof(pollfd));
+        }
+        ++m_pollFdCount;
+    }
+    m_pollFds[i].fd = fileDescriptor;
+    m_pollFds[i].events = ((events & Read) ? POLLIN : 0) | ((events & Write) ? POLLOUT : 0);
+    m_pollFds[i].revents = 0;
+}
+
+void EventLoop::PrivateImpl::unwatch(iint32 fileDescriptor)
+{
+    for (size_t i = 1; i < m_pollFdCount; ++i) {
+        if (m_pollFds[i].fd == fileDescriptor) {
+            m_pollFds[i] = m_pollFds[m_pollFdCount - 1];
+            --m_pollFdCount;
+            return;
+        }
+    }
+}
+
+size_t EventLoop::PrivateImpl::waitForEvents(iint32 timeout, ReadyFileDescriptor *ready)
+{
+    if (poll(m_pollFds, m_pollFdCount, timeout) <= 0) {
+        return 0;
+    }
+    if (m_pollFds[0].revents) {
+        ichar buffer[64];
+        while (read(m_wakeUpPipe[0], buffer, sizeof(buffer)) > 0) {
+        }
+    }
+    size_t res = 0;
+    for (size_t i = 1; i < m_pollFdCount && res < readyBatchSize; ++i) {
+        const short revents = m_pollFds[i].revents;
+        if (!revents) {
+            continue;
+        }
+        ready[res].fileDescriptor = m_pollFds[i].fd;
+        ready[res].events = ((revents & (POLLIN | POLLHUP | POLLERR)) ? Read : 0) |
+                            ((revents & POLLOUT) ? Write : 0);
+        ++res;
+    }
+    return res;
+}
+
+}
@@ -0,0 +1,119 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <core/shared_memory_channel.h>
+#include "shared_memory_channel_p.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <atomic>
+
+namespace IdealCore {
+
+SharedMemoryChannel::PrivateImpl::PrivateImpl()
+{
+    m_wakeUpPipe[0] = m_wakeUpPipe[1] = -1;
+}
+
+SharedMemoryChannel::PrivateImpl::~PrivateImpl()
+{
+    if (m_wakeUpPipe[0] != -1) {
+        close(m_wakeUpPipe[0]);
+        close(m_wakeUpPipe[1]);
+    }
+}
+
+bool SharedMemoryChannel::PrivateImpl::create(size_t size)
+{
+    static std::atomic<iuint32> s_counter(0);
+    ichar name[64];
+    do {
+        snprintf(name, sizeof(name), "/ideal-shared-memory-channel-%d-%u", (iint32) getpid(), s_counter.fetch_add(1));
+        m_memory = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    } while (m_memory == -1 && errno == EEXIST);
+    if (m_memory == -1) {
+        IDEAL_DEBUG_WARNING("could not create the memory of the shared memory channel");
+        return false;
+    }
+    // The name is only needed to create it: it is shared by its descriptor, and freed once nobody
+    // maps it or holds its descriptor
+    shm_unlink(name);
+    if (ftruncate(m_memory, size)) {
+        IDEAL_DEBUG_WARNING("could not create the memory of the shared memory channel");
+        return false;
+    }
+    if (pipe(m_wakeUpPipe)) {
+        IDEAL_DEBUG_WARNING("could not create the wake up pipe of the shared memory channel");
+        m_wakeUpPipe[0] = m_wakeUpPipe[1] = -1;
+        return false;
+    }
+    for (iint32 i = 0; i < 2; ++i) {
+        fcntl(m_wakeUpPipe[i], F_SETFL, fcntl(m_wakeUpPipe[i], F_GETFL) | O_NONBLOCK);
+    }
+    return true;
+}
+
+size_t SharedMemoryChannel::PrivateImpl::descriptors(iint32 *descriptors) const
+{
+    descriptors[0] = m_memory;
+    descriptors[1] = m_wakeUpPipe[0];
+    descriptors[2] = m_wakeUpPipe[1];
+    return 3;
+}
+
+bool SharedMemoryChannel::PrivateImpl::adopt(const iint32 *descriptors, size_t count)
+{
+    if (count != 3) {
+        return false;
+    }
+    // The pipe keeps being non blocking, as that is a property of the open file it refers to
+    m_memory = descriptors[0];
+    m_wakeUpPipe[0] = descriptors[1];
+    m_wakeUpPipe[1] = descriptors[2];
+    return true;
+}
+
+void SharedMemoryChannel::PrivateImpl::wakeUp()
+{
+    // If the pipe is full a wake up is already pending, so the write can be lost
+    const ichar byte = 0;
+    while (write(m_wakeUpPipe[1], &byte, 1) == -1 && errno == EINTR) {
+    }
+}
+
+void SharedMemoryChannel::PrivateImpl::clearWakeUp()
+{
+    ichar buffer[64];
+    ssize_t res;
+    do {
+        res = read(m_wakeUpPipe[0], buffer, sizeof(buffer));
+    } while (res > 0 || (res == -1 && errno == EINTR));
+}
+
+iint32 SharedMemoryChannel::PrivateImpl::fileDescriptor() const
+{
+    return m_wakeUpPipe[0];
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SHARED_MEMORY_CHANNEL_P_H_POSIX
+#define SHARED_MEMORY_CHANNEL_P_H_POSIX
+
+#include <core/private/shared_memory_channel_p.h>
+
+namespace IdealCore {
+
+class SharedMemoryChannel::PrivateImpl
+    : public SharedMemoryChannel::Private
+{
+public:
+    PrivateImpl();
+    virtual ~PrivateImpl();
+
+    /**
+      * Creates m_memory, of @p size bytes, and the wake up mechanism.
+      */
+    bool create(size_t size);
+
+    /**
+      * Writes m_memory and the descriptors of the wake up mechanism into @p descriptors, which has
+      * room for MaxDescriptors of them.
+      *
+      * @return The number of descriptors written.
+      */
+    size_t descriptors(iint32 *descriptors) const;
+
+    /**
+      * Takes ownership of the @p count descriptors written by descriptors() on another process.
+      *
+      * @return False if they do not come from this backend, in which case they are not taken.
+      */
+    bool adopt(const iint32 *descriptors, size_t count);
+
+    /**
+      * Makes fileDescriptor() readable. Never blocks.
+      */
+    void wakeUp();
+
+    /**
+      * Makes fileDescriptor() not readable.
+      */
+    void clearWakeUp();
+
+    iint32 fileDescriptor() const;
+
+    iint32 m_wakeUpPipe[2];
+};
+
+}
+
+#endif //SHARED_MEMORY_CHANNEL_P_H_POSIX
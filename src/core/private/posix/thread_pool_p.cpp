@@ -0,0 +1,61 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <core/thread_pool.h>
+#include "thread_pool_p.h"
+
+#include <unistd.h>
+
+namespace IdealCore {
+
+ThreadPool::PrivateImpl::PrivateImpl(size_t threadCount)
+    : Private(threadCount)
+    , m_threads(new pthread_t[threadCount])
+{
+    for (size_t i = 0; i < threadCount; ++i) {
+        pthread_create(&m_threads[i], 0, entryPoint, this);
+    }
+}
+
+ThreadPool::PrivateImpl::~PrivateImpl()
+{
+    delete[] m_threads;
+}
+
+void ThreadPool::PrivateImpl::join()
+{
+    for (size_t i = 0; i < m_threadCount; ++i) {
+        pthread_join(m_threads[i], 0);
+    }
+}
+
+size_t ThreadPool::PrivateImpl::hardwareThreadCount()
+{
+    const long threadCount = sysconf(_SC_NPROCESSORS_ONLN);
+    return threadCount > 0 ? threadCount : 1;
+}
+
+void *ThreadPool::PrivateImpl::entryPoint(void *param)
+{
+    static_cast<PrivateImpl*>(param)->work();
+    return 0;
+}
+
+}
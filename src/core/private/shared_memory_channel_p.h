@@ -0,0 +1,98 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SHARED_MEMORY_CHANNEL_P_H
+#define SHARED_MEMORY_CHANNEL_P_H
+
+#include <core/shared_memory_channel.h>
+
+#include <atomic>
+
+namespace IdealCore {
+
+class SharedMemoryChannel::Private
+{
+public:
+    Private();
+    virtual ~Private();
+
+    /**
+      * The most descriptors a backend needs to share a channel: the shared memory and its wake up
+      * mechanism.
+      */
+    static const size_t MaxDescriptors = 3;
+
+    /**
+      * Sends the @p count @p descriptors through the unix domain socket @p socket.
+      */
+    static bool sendDescriptors(iint32 socket, const iint32 *descriptors, size_t count);
+
+    /**
+      * Receives up to MaxDescriptors @p descriptors through the unix domain socket @p socket.
+      *
+      * @return The number of descriptors received, which are owned by the caller.
+      */
+    static size_t receiveDescriptors(iint32 socket, iint32 *descriptors);
+
+    /**
+      * A bounded queue with a sequence number per slot, as described by Dmitry Vyukov. Senders
+      * reserve a slot by advancing m_sendPosition, and publish it by storing its sequence number.
+      * It lives at the start of the shared memory, followed by the slots.
+      */
+    struct Header
+    {
+        std::atomic<iuint64> m_sendPosition;
+        ichar                m_sendPadding[56];
+        std::atomic<iuint64> m_receivePosition;
+        // Whether the receiver waits for fileDescriptor(). The sender that clears it wakes it up
+        std::atomic<iuint32> m_waiting;
+        std::atomic<iuint64> m_dropped;
+        iuint64              m_capacity;
+        iuint64              m_messageSize;
+        iuint64              m_slotSize;
+    };
+
+    struct Slot
+    {
+        std::atomic<iuint64> m_sequence;
+        ichar                m_message[8];
+    };
+
+    Slot *slot(iuint64 position) const
+    {
+        return reinterpret_cast<Slot*>(reinterpret_cast<ichar*>(m_header + 1) +
+                                       (position & (m_header->m_capacity - 1)) * m_header->m_slotSize);
+    }
+
+    Header      *m_header;
+    size_t       m_size;
+    iint32       m_memory;
+    ForwardBase *m_forward;
+};
+
+}
+
+#if defined(IDEAL_OS_LINUX)
+#include <core/private/linux/shared_memory_channel_p.h>
+#elif defined(IDEAL_OS_POSIX)
+#include <core/private/posix/shared_memory_channel_p.h>
+#endif
+
+#endif //SHARED_MEMORY_CHANNEL_P_H
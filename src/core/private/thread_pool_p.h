@@ -0,0 +1,52 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef THREAD_POOL_P_H
+#define THREAD_POOL_P_H
+
+#include <core/thread_pool.h>
+#include <core/mutex.h>
+#include <core/cond_var.h>
+
+namespace IdealCore {
+
+class ThreadPool::Private
+{
+public:
+    Private(size_t threadCount);
+    virtual ~Private();
+
+    void work();
+
+    size_t   m_threadCount;
+    Mutex    m_mutex;
+    CondVar  m_condition;
+    Task    *m_head;
+    Task    *m_tail;
+    bool     m_stop;
+};
+
+}
+
+#ifdef IDEAL_OS_POSIX
+#include <core/private/posix/thread_pool_p.h>
+#endif //IDEAL_OS_POSIX
+
+#endif //THREAD_POOL_P_H
@@ -0,0 +1,126 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef URI_PARSER_P_H
+#define URI_PARSER_P_H
+
+#include <ideal_export.h>
+
+namespace IdealCore {
+
+/**
+  * @internal
+  *
+  * RFC 3986 parser working on raw bytes. It does not allocate and does not normalize anything, it
+  * only validates and reports where each component starts and how long it is. Uri has its own
+  * parser, since it also normalizes the path and decodes percent encoded characters.
+  *
+  * In Lenient mode the same characters Uri accepts are accepted: non ASCII bytes and ASCII
+  * characters that should have been percent encoded (like spaces). Strict mode only accepts what
+  * RFC 3986 allows.
+  */
+class UriParser
+{
+public:
+    enum Component {
+        Scheme = 0,
+        UserInfo,
+        Host,
+        Port,
+        Path,
+        Query,
+        Fragment,
+        ComponentCount
+    };
+
+    enum Mode {
+        Lenient = 0,
+        Strict
+    };
+
+    static const size_t npos = -1;
+
+    struct Components
+    {
+        void clear();
+
+        size_t begin[ComponentCount];   ///< npos if the component is not present
+        size_t length[ComponentCount];
+        iint32 port;                    ///< -1 if no port is present
+    };
+
+    UriParser(const ichar *str, size_t size, Mode mode = Lenient);
+
+    /**
+      * Parses the whole input as a URI-reference.
+      *
+      * @return Whether the whole input is a valid URI-reference.
+      */
+    bool parseUriReference(Components &components);
+
+    /**
+      * Parses the longest prefix of the input that is a URI (it has to have a scheme).
+      *
+      * @return The number of bytes of that URI. 0 if the input does not start with a URI.
+      */
+    size_t parseUri(Components &components);
+
+    /**
+      * Parses the longest prefix of the input that is an authority followed by an optional
+      * path-abempty, query and fragment. That is, a URI with its scheme and "//" left out, as in
+      * "www.example.com/index.html".
+      *
+      * @return The number of bytes parsed. 0 if the input does not start with an authority.
+      */
+    size_t parseAuthorityPrefix(Components &components);
+
+    /**
+      * @return Whether @p c can be part of a URI in Strict mode (unreserved, reserved or '%').
+      */
+    static bool isUriCharacter(ichar c);
+
+    /**
+      * Parses the longest prefix of @p str that is an IPv6address. The address is stored in
+      * @p address (16 bytes, network byte order) and its length in @p consumed.
+      *
+      * @return Whether @p str starts with a valid IPv6 address.
+      */
+    static bool parseIPv6Address(const ichar *str, size_t size, iuint8 *address, size_t &consumed);
+
+private:
+    bool parseUriAt(Components &components);
+    bool parseRelativeRef(Components &components);
+    bool parseScheme(Components &components);
+    bool parseAuthority(Components &components);
+    bool parseHost(Components &components);
+    bool parseIPvFuture();
+    void parsePath(Components &components, bool allowColon);
+    void parseQueryAndFragment(Components &components);
+    size_t scan(iuint32 mask);
+
+    const ichar *const m_str;
+    const size_t       m_size;
+    const Mode         m_mode;
+    size_t             m_pos;
+};
+
+}
+
+#endif //URI_PARSER_P_H
@@ -34,26 +34,29 @@ namespace IdealCore {
   * have dangle pointers using SafePointer. Example:
   *
   * @code
-  * MyObject *myObject = new MyObject; // MyObject class inherits IdealCore::Object
+  * MyObject *myObject = new MyObject; // MyObject class inherits IdealCore::SignalResource
   * SafePointer<MyObject> myPointer(myObject);
   * myPointer->someMethod();
   * delete myObject;
   * myPointer->someMethod(); // error, myPointer is pointing to 0
   * @endcode
   *
-  * @note For this to work, T class has to inherit IdealCore::Object.
+  * All safe pointers to the same content share a weak reference to it, so creating, copying and
+  * checking them do not allocate nor connect to any signal. The content is seen as destroyed once
+  * its SignalResource destructor runs, that is, after the destructors of its subclasses.
+  *
+  * @note For this to work, T class has to inherit IdealCore::SignalResource.
   *
   * @author Rafael Fernández López <ereslibre@ereslibre.es>
   */
 template <typename T>
 class SafePointer
-    : public SignalResource
 {
 public:
     /**
       * Creates the safe pointer with content @p content.
       *
-      * @note T has to inherit IdealCore::Object.
+      * @note T has to inherit IdealCore::SignalResource.
       */
     SafePointer(T *content = 0);
 
@@ -62,12 +65,7 @@ public:
     /**
       * @note This will not destroy the contents.
       */
-    virtual ~SafePointer();
-
-    /**
-      * @internal
-      */
-    void contentDestroyed();
+    ~SafePointer();
 
     /**
       * @return The content. 0 if the content was destroyed.
@@ -108,16 +106,12 @@ public:
       */
     bool isContentDestroyed() const;
 
-    /**
-      * @internal
-      */
-    bool areSignalsBlocked() const;
-
     bool operator==(T *t) const;
     bool operator!=(T *t) const;
 
 private:
-    T *m_t;
+    T              *m_t;
+    WeakReference  *m_weakReference;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -125,53 +119,46 @@ private:
 template <typename T>
 SafePointer<T>::SafePointer(T *content)
     : m_t(content)
+    , m_weakReference(content ? content->weakReference() : 0)
 {
-    if (m_t) {
-        m_t->destroyed.connect(this, &SafePointer<T>::contentDestroyed);
-    }
 }
 
 template <typename T>
 SafePointer<T>::SafePointer(const SafePointer &ptr)
     : m_t(ptr.m_t)
+    , m_weakReference(ptr.m_weakReference)
 {
-    if (m_t) {
-        m_t->destroyed.connect(this, &SafePointer<T>::contentDestroyed);
+    if (m_weakReference) {
+        m_weakReference->ref();
     }
 }
 
-
 template <typename T>
 SafePointer<T>::~SafePointer()
 {
-    if (m_t) {
-        m_t->destroyed.disconnect(this);
+    if (m_weakReference) {
+        m_weakReference->deref();
     }
- }
-
-template <typename T>
-void SafePointer<T>::contentDestroyed()
-{
-    m_t = 0;
 }
 
 template <typename T>
 T *SafePointer<T>::content() const
 {
-    return m_t;
+    return m_weakReference && m_weakReference->isAlive() ? m_t : 0;
 }
 
 template <typename T>
 bool SafePointer<T>::operator!() const
 {
-    return m_t == 0;
+    return content() == 0;
 }
 
 template <typename T>
 T &SafePointer<T>::operator*() const
 {
-    if (m_t) {
-        return *m_t;
+    T *const t = content();
+    if (t) {
+        return *t;
     }
     // Ouch !
 #ifndef NDEBUG
@@ -183,63 +170,56 @@ T &SafePointer<T>::operator*() const
 template <typename T>
 T *SafePointer<T>::operator->() const
 {
-    return m_t;
+    return content();
 }
 
 template <typename T>
 SafePointer<T>::operator bool() const
 {
-    return m_t;
+    return content();
 }
 
 template <typename T>
 SafePointer<T> &SafePointer<T>::operator=(const SafePointer &ptr)
 {
-    if (m_t) {
-        m_t->destroyed.disconnect(this);
+    if (ptr.m_weakReference) {
+        ptr.m_weakReference->ref();
     }
-    m_t = ptr.m_t;
-    if (m_t) {
-        m_t->destroyed.connect(this, &SafePointer<T>::contentDestroyed);
+    if (m_weakReference) {
+        m_weakReference->deref();
     }
+    m_t = ptr.m_t;
+    m_weakReference = ptr.m_weakReference;
     return *this;
 }
 
 template <typename T>
 SafePointer<T> &SafePointer<T>::operator=(T *content)
 {
-    if (m_t) {
-        m_t->destroyed.disconnect(this);
+    if (m_weakReference) {
+        m_weakReference->deref();
     }
     m_t = content;
-    if (m_t) {
-        m_t->destroyed.connect(this, &SafePointer<T>::contentDestroyed);
-    }
+    m_weakReference = content ? content->weakReference() : 0;
     return *this;
 }
 
 template <typename T>
 bool SafePointer<T>::isContentDestroyed() const
 {
-    return m_t == 0;
-}
-
-template <typename T>
-bool SafePointer<T>::areSignalsBlocked() const
-{
-    return false;
+    return content() == 0;
 }
 
 template <typename T>
 bool SafePointer<T>::operator==(T *t) const
 {
-    return m_t == t;
+    return content() == t;
 }
 
 template <typename T>
 bool SafePointer<T>::operator!=(T *t) const
 {
-    return m_t != t;
+    return content() != t;
 }
 
 }
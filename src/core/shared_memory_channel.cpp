@@ -0,0 +1,345 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "shared_memory_channel.h"
+#include "private/shared_memory_channel_p.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include <new>
+
+namespace IdealCore {
+
+SharedMemoryChannel::Private::Private()
+    : m_header(0)
+    , m_size(0)
+    , m_memory(-1)
+    , m_forward(0)
+{
+}
+
+SharedMemoryChannel::Private::~Private()
+{
+}
+
+bool SharedMemoryChannel::Private::sendDescriptors(iint32 socket, const iint32 *descriptors, size_t count)
+{
+    // At least one byte of data has to go along with the descriptors
+    ichar byte = 0;
+    iovec data;
+    data.iov_base = &byte;
+    data.iov_len = 1;
+    ichar control[CMSG_SPACE(sizeof(iint32) * MaxDescriptors)];
+    memset(control, 0, sizeof(control));
+    msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = CMSG_SPACE(sizeof(iint32) * count);
+    cmsghdr *const header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(iint32) * count);
+    memcpy(CMSG_DATA(header), descriptors, sizeof(iint32) * count);
+    ssize_t res;
+    do {
+        res = sendmsg(socket, &message, 0);
+    } while (res == -1 && errno == EINTR);
+    return res == 1;
+}
+
+size_t SharedMemoryChannel::Private::receiveDescriptors(iint32 socket, iint32 *descriptors)
+{
+    ichar byte;
+    iovec data;
+    data.iov_base = &byte;
+    data.iov_len = 1;
+    ichar control[CMSG_SPACE(sizeof(iint32) * MaxDescriptors)];
+    msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    ssize_t res;
+    do {
+        res = recvmsg(socket, &message, 0);
+    } while (res == -1 && errno == EINTR);
+    if (res != 1) {
+        return 0;
+    }
+    size_t count = 0;
+    for (cmsghdr *header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        const size_t received = (header->cmsg_len - CMSG_LEN(0)) / sizeof(iint32);
+        memcpy(descriptors + count, CMSG_DATA(header), sizeof(iint32) * received);
+        count += received;
+    }
+    if (message.msg_flags & MSG_CTRUNC) {
+        // Some were not received, so the ones that were are of no use
+        for (size_t i = 0; i < count; ++i) {
+            close(descriptors[i]);
+        }
+        return 0;
+    }
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SharedMemoryChannel::ForwardBase::ForwardBase(SharedMemoryChannel *channel, EventLoop &eventLoop)
+    : m_channel(channel)
+    , m_eventLoop(eventLoop)
+    , m_message(malloc(channel->messageSize()))
+{
+    eventLoop.readyRead.connect(this, &ForwardBase::readyRead);
+    eventLoop.watch(channel->fileDescriptor(), EventLoop::Read);
+    // Messages can have been sent before, without waking anybody up
+    static_cast<PrivateImpl*>(channel->d)->wakeUp();
+}
+
+SharedMemoryChannel::ForwardBase::~ForwardBase()
+{
+    m_eventLoop.unwatch(m_channel->fileDescriptor());
+    m_eventLoop.readyRead.disconnect(this);
+    free(m_message);
+}
+
+void SharedMemoryChannel::ForwardBase::readyRead(const iint32 &fileDescriptor)
+{
+    if (fileDescriptor != m_channel->fileDescriptor()) {
+        return;
+    }
+    do {
+        while (m_channel->receive(m_message)) {
+            emitMessage(m_message);
+        }
+    } while (!m_channel->prepareToWait());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SharedMemoryChannel::SharedMemoryChannel()
+    : d(new PrivateImpl)
+{
+}
+
+SharedMemoryChannel::SharedMemoryChannel(size_t messageSize, size_t capacity)
+    : d(new PrivateImpl)
+{
+    iuint64 roundedCapacity = 2;
+    while (roundedCapacity < capacity) {
+        roundedCapacity *= 2;
+    }
+    const iuint64 slotSize = sizeof(Private::Slot) - sizeof(Private::Slot::m_message) + ((messageSize + 7) & ~7);
+    d->m_size = sizeof(Private::Header) + roundedCapacity * slotSize;
+    if (!static_cast<PrivateImpl*>(d)->create(d->m_size)) {
+        return;
+    }
+    // Shared with the processes forked from now on, and with the ones share() sends it to
+    void *const memory = mmap(0, d->m_size, PROT_READ | PROT_WRITE, MAP_SHARED, d->m_memory, 0);
+    if (memory == MAP_FAILED) {
+        IDEAL_DEBUG_WARNING("could not map the memory of the shared memory channel");
+        return;
+    }
+    Private::Header *const header = static_cast<Private::Header*>(memory);
+    new (&header->m_sendPosition) std::atomic<iuint64>(0);
+    new (&header->m_receivePosition) std::atomic<iuint64>(0);
+    // Until forward() is called or the receiver waits for the first time, senders do not know
+    // whether it waits
+    new (&header->m_waiting) std::atomic<iuint32>(1);
+    new (&header->m_dropped) std::atomic<iuint64>(0);
+    header->m_capacity = roundedCapacity;
+    header->m_messageSize = messageSize;
+    header->m_slotSize = slotSize;
+    d->m_header = header;
+    for (iuint64 i = 0; i < roundedCapacity; ++i) {
+        new (&d->slot(i)->m_sequence) std::atomic<iuint64>(i);
+    }
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+    delete d->m_forward;
+    if (d->m_header) {
+        munmap(d->m_header, d->m_size);
+    }
+    if (d->m_memory != -1) {
+        close(d->m_memory);
+    }
+    delete d;
+}
+
+SharedMemoryChannel *SharedMemoryChannel::attach(iint32 socket)
+{
+    iint32 descriptors[Private::MaxDescriptors];
+    const size_t count = Private::receiveDescriptors(socket, descriptors);
+    if (!count) {
+        IDEAL_DEBUG_WARNING("could not receive the shared memory channel");
+        return 0;
+    }
+    SharedMemoryChannel *const channel = new SharedMemoryChannel;
+    Private *const d = channel->d;
+    if (!static_cast<PrivateImpl*>(d)->adopt(descriptors, count)) {
+        IDEAL_DEBUG_WARNING("the shared memory channel was sent by a different backend");
+        for (size_t i = 0; i < count; ++i) {
+            close(descriptors[i]);
+        }
+        delete channel;
+        return 0;
+    }
+    struct stat status;
+    if (fstat(d->m_memory, &status) || (size_t) status.st_size < sizeof(Private::Header)) {
+        IDEAL_DEBUG_WARNING("the memory of the shared memory channel is not valid");
+        delete channel;
+        return 0;
+    }
+    void *const memory = mmap(0, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, d->m_memory, 0);
+    if (memory == MAP_FAILED) {
+        IDEAL_DEBUG_WARNING("could not map the memory of the shared memory channel");
+        delete channel;
+        return 0;
+    }
+    d->m_header = static_cast<Private::Header*>(memory);
+    d->m_size = status.st_size;
+    // Already initialized by the process that created it. Check that it fits, as slot() trusts it
+    const Private::Header *const header = d->m_header;
+    if (!header->m_capacity || (header->m_capacity & (header->m_capacity - 1)) ||
+        header->m_slotSize < sizeof(Private::Slot) - sizeof(Private::Slot::m_message) + header->m_messageSize ||
+        header->m_capacity > (d->m_size - sizeof(Private::Header)) / header->m_slotSize) {
+        IDEAL_DEBUG_WARNING("the memory of the shared memory channel is not valid");
+        delete channel;
+        return 0;
+    }
+    return channel;
+}
+
+bool SharedMemoryChannel::isValid() const
+{
+    return d->m_header && fileDescriptor() != -1;
+}
+
+bool SharedMemoryChannel::share(iint32 socket) const
+{
+    if (!isValid()) {
+        return false;
+    }
+    iint32 descriptors[Private::MaxDescriptors];
+    const size_t count = static_cast<const PrivateImpl*>(d)->descriptors(descriptors);
+    return Private::sendDescriptors(socket, descriptors, count);
+}
+
+size_t SharedMemoryChannel::messageSize() const
+{
+    return d->m_header ? d->m_header->m_messageSize : 0;
+}
+
+bool SharedMemoryChannel::send(const void *message, size_t size)
+{
+    Private::Header *const header = d->m_header;
+    if (!header || size > header->m_messageSize) {
+        return false;
+    }
+    iuint64 position = header->m_sendPosition.load(std::memory_order_relaxed);
+    Private::Slot *slot;
+    do {
+        slot = d->slot(position);
+        const iint64 difference = (iint64) (slot->m_sequence.load(std::memory_order_acquire) - position);
+        if (!difference) {
+            if (header->m_sendPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            header->m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = header->m_sendPosition.load(std::memory_order_relaxed);
+        }
+    } while (true);
+    memcpy(slot->m_message, message, size);
+    // Ordered with the store to m_waiting in prepareToWait(): either we see the receiver waiting,
+    // or it sees this message
+    slot->m_sequence.store(position + 1, std::memory_order_seq_cst);
+    if (header->m_waiting.load(std::memory_order_seq_cst) && header->m_waiting.exchange(0, std::memory_order_seq_cst)) {
+        static_cast<PrivateImpl*>(d)->wakeUp();
+    }
+    return true;
+}
+
+bool SharedMemoryChannel::receive(void *message)
+{
+    Private::Header *const header = d->m_header;
+    if (!header) {
+        return false;
+    }
+    const iuint64 position = header->m_receivePosition.load(std::memory_order_relaxed);
+    Private::Slot *const slot = d->slot(position);
+    if (slot->m_sequence.load(std::memory_order_acquire) != position + 1) {
+        return false;
+    }
+    memcpy(message, slot->m_message, header->m_messageSize);
+    slot->m_sequence.store(position + header->m_capacity, std::memory_order_release);
+    header->m_receivePosition.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool SharedMemoryChannel::prepareToWait()
+{
+    Private::Header *const header = d->m_header;
+    if (!header) {
+        return true;
+    }
+    static_cast<PrivateImpl*>(d)->clearWakeUp();
+    header->m_waiting.store(1, std::memory_order_seq_cst);
+    const iuint64 position = header->m_receivePosition.load(std::memory_order_relaxed);
+    if (d->slot(position)->m_sequence.load(std::memory_order_seq_cst) != position + 1) {
+        return true;
+    }
+    // If a sender cleared it already, fileDescriptor() becomes readable once more, which is harmless
+    header->m_waiting.store(0, std::memory_order_relaxed);
+    return false;
+}
+
+iint32 SharedMemoryChannel::fileDescriptor() const
+{
+    return static_cast<const PrivateImpl*>(d)->fileDescriptor();
+}
+
+iuint64 SharedMemoryChannel::droppedCount() const
+{
+    return d->m_header ? d->m_header->m_dropped.load(std::memory_order_relaxed) : 0;
+}
+
+void SharedMemoryChannel::setForward(ForwardBase *forward)
+{
+    delete d->m_forward;
+    d->m_forward = forward;
+}
+
+}
@@ -0,0 +1,277 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SHARED_MEMORY_CHANNEL_H
+#define SHARED_MEMORY_CHANNEL_H
+
+#include <ideal_export.h>
+#include <core/event_loop.h>
+#include <core/ideal_signal.h>
+
+#include <tuple>
+
+namespace IdealCore {
+
+/**
+  * @class SharedMemoryChannel shared_memory_channel.h core/shared_memory_channel.h
+  *
+  * A queue of fixed size messages in memory shared between processes of the same host. Any number
+  * of threads, on any of the processes, can send messages, and one of them receives them. Sending
+  * never blocks nor makes a system call, unless the receiver is waiting for messages, in which case
+  * it is woken up once.
+  *
+  * The channel is inherited by the processes created with fork() after it. Other processes of the
+  * same host can use it too: share() sends it over a connected unix domain socket, and attach()
+  * maps it on the process at the other end.
+  *
+  * Its main use is to connect signals across processes. Signal::connectShared() sends the
+  * arguments of each emission, and forward() emits a signal with them on the receiving process:
+  *
+  * @code
+  * SharedMemoryChannel channel(sizeof(std::tuple<iint32>));
+  * if (fork()) {
+  *     // Parent: slots connected to progress are called from the thread running eventLoop
+  *     channel.forward(progress, eventLoop);
+  *     eventLoop.exec();
+  * } else {
+  *     // Child
+  *     worker.progress.connectShared(channel);
+  * }
+  * @endcode
+  *
+  * Or, with a process that was not forked from the one creating the channel:
+  *
+  * @code
+  * // Receiver, connected to the sender through the unix domain socket sock
+  * SharedMemoryChannel channel(sizeof(std::tuple<iint32>));
+  * channel.forward(progress, eventLoop);
+  * channel.share(sock);
+  *
+  * // Sender
+  * SharedMemoryChannel *channel = SharedMemoryChannel::attach(sock);
+  * worker.progress.connectShared(*channel);
+  * @endcode
+  *
+  * @note Only trivially copyable arguments can be sent.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT SharedMemoryChannel
+{
+public:
+    /**
+      * Creates a channel for messages of up to @p messageSize bytes, that can hold @p capacity of
+      * them, rounded up to a power of two.
+      */
+    SharedMemoryChannel(size_t messageSize, size_t capacity = 1024);
+
+    /**
+      * Maps the channel received through the unix domain socket @p socket, sent by share() on
+      * another process. Blocks until it is received if @p socket is blocking.
+      *
+      * @return The channel, to be deleted by the caller, or 0 if it could not be received or
+      *         mapped.
+      */
+    static SharedMemoryChannel *attach(iint32 socket);
+
+    /**
+      * Unmaps the channel on this process. It is freed once all processes unmapped it.
+      */
+    ~SharedMemoryChannel();
+
+    /**
+      * @return Whether the shared memory and the wake up mechanism could be created.
+      */
+    bool isValid() const;
+
+    /**
+      * Sends this channel through the connected unix domain socket @p socket, so that the process
+      * at the other end can attach() to it. Can be called any number of times.
+      *
+      * @return Whether it could be sent.
+      */
+    bool share(iint32 socket) const;
+
+    /**
+      * @return The maximum size of a message.
+      */
+    size_t messageSize() const;
+
+    /**
+      * Copies @p size bytes of @p message into the channel. Can be called from any thread of any
+      * process, and never blocks.
+      *
+      * @return False if @p size is greater than messageSize(), or if the channel is full, in
+      *         which case the message is dropped and counted in droppedCount().
+      */
+    bool send(const void *message, size_t size);
+
+    /**
+      * Copies the oldest message into @p message, which has room for messageSize() bytes. Only one
+      * thread, on one process, can receive.
+      *
+      * @return False if there are no messages.
+      */
+    bool receive(void *message);
+
+    /**
+      * Tells senders that the receiver is going to wait until fileDescriptor() is readable.
+      *
+      * @return False if messages arrived meanwhile, in which case the receiver has to keep
+      *         receiving instead of waiting.
+      */
+    bool prepareToWait();
+
+    /**
+      * @return The file descriptor that becomes readable when a message is sent after
+      *         prepareToWait() was called.
+      */
+    iint32 fileDescriptor() const;
+
+    /**
+      * @return The number of messages dropped because the channel was full.
+      */
+    iuint64 droppedCount() const;
+
+    /**
+      * Emits @p signal from the thread running @p eventLoop with the arguments of each message
+      * received, until this channel is destroyed. Messages have to be sent with
+      * Signal::connectShared() from a signal with the same parameters. Replaces the previous
+      * forward, if any.
+      *
+      * @note This channel has to be destroyed before @p eventLoop, from the thread running it or
+      *       before it runs.
+      */
+    template <typename... Param>
+    void forward(const Signal<Param...> &signal, EventLoop &eventLoop);
+
+private:
+    SharedMemoryChannel();
+    SharedMemoryChannel(const SharedMemoryChannel &sharedMemoryChannel);
+    SharedMemoryChannel &operator=(const SharedMemoryChannel &sharedMemoryChannel);
+
+    /**
+      * Receives messages while fileDescriptor() is readable, and emits a signal with each of them.
+      */
+    class ForwardBase
+        : public SignalResource
+    {
+    public:
+        ForwardBase(SharedMemoryChannel *channel, EventLoop &eventLoop);
+        virtual ~ForwardBase();
+
+        void readyRead(const iint32 &fileDescriptor);
+
+        /**
+          * Emits the signal with @p message.
+          */
+        virtual void emitMessage(const void *message) = 0;
+
+        SharedMemoryChannel *const m_channel;
+        EventLoop                 &m_eventLoop;
+        void                *const m_message;
+    };
+
+    template <typename... Param>
+    class Forward;
+
+    void setForward(ForwardBase *forward);
+
+    class Private;
+    class PrivateImpl;
+    Private *const d;
+};
+
+/**
+  * @internal
+  */
+template <typename... Param>
+class SharedMemoryChannel::Forward
+    : public SharedMemoryChannel::ForwardBase
+{
+public:
+    Forward(SharedMemoryChannel *channel, EventLoop &eventLoop, const Signal<Param...> &signal)
+        : ForwardBase(channel, eventLoop)
+        , m_signal(signal)
+    {
+    }
+
+    virtual void emitMessage(const void *message)
+    {
+        emitArguments(*static_cast<const std::tuple<Param...>*>(message), typename MakeIndexList<sizeof...(Param)>::Type());
+    }
+
+private:
+    template <size_t... Index>
+    void emitArguments(const std::tuple<Param...> &arguments, IndexList<Index...>)
+    {
+        m_signal.emit(std::get<Index>(arguments)...);
+    }
+
+    const Signal<Param...> &m_signal;
+};
+
+template <typename... Param>
+void SharedMemoryChannel::forward(const Signal<Param...> &signal, EventLoop &eventLoop)
+{
+    setForward(new Forward<Param...>(this, eventLoop, signal));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  */
+template <typename... Param>
+class CallbackShared
+    : public CallbackBase<Param...>
+{
+public:
+    CallbackShared(SharedMemoryChannel &channel)
+        : m_channel(channel)
+    {
+        this->m_receiver = 0;
+        if (channel.messageSize() < sizeof(std::tuple<Param...>)) {
+            IDEAL_DEBUG_WARNING("the messages of the shared memory channel are too small for this signal");
+        }
+    }
+
+    virtual void operator()(const Param&... param)
+    {
+        const std::tuple<Param...> arguments(param...);
+        m_channel.send(&arguments, sizeof(arguments));
+    }
+
+private:
+    SharedMemoryChannel &m_channel;
+};
+
+/**
+  * @internal
+  */
+template <typename... Param>
+CallbackBase<Param...> *CallbackBase<Param...>::makeShared(SharedMemoryChannel &channel)
+{
+    return new CallbackShared<Param...>(channel);
+}
+
+}
+
+#endif //SHARED_MEMORY_CHANNEL_H
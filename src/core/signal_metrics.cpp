@@ -0,0 +1,476 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "signal_metrics.h"
+
+#ifdef IDEAL_SIGNAL_METRICS
+
+#include <iomanip>
+#include <sstream>
+#include <time.h>
+
+namespace IdealCore {
+
+/**
+  * @internal
+  *
+  * All existing records, linked through m_previous and m_next. Function statics, so signals of
+  * static objects can be created before this file is initialized.
+  */
+static Mutex &registryMutex()
+{
+    static Mutex mutex;
+    return mutex;
+}
+
+static SignalMetrics::Record *&firstRecord()
+{
+    static SignalMetrics::Record *record = 0;
+    return record;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SignalMetrics::Histogram::Histogram()
+    : m_shards(0)
+{
+}
+
+SignalMetrics::Histogram::~Histogram()
+{
+    delete[] m_shards.load(std::memory_order_relaxed);
+}
+
+void SignalMetrics::Histogram::record(iuint64 value)
+{
+    Shard &shard = shards()[SignalMetrics::shard()];
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+iuint64 SignalMetrics::Histogram::count() const
+{
+    const Shard *const shards = m_shards.load(std::memory_order_acquire);
+    if (!shards) {
+        return 0;
+    }
+    iuint64 res = 0;
+    for (size_t i = 0; i < shardCount; ++i) {
+        for (size_t j = 0; j < bucketCount; ++j) {
+            res += shards[i].buckets[j].load(std::memory_order_relaxed);
+        }
+    }
+    return res;
+}
+
+iuint64 SignalMetrics::Histogram::mean() const
+{
+    const iuint64 valueCount = count();
+    if (!valueCount) {
+        return 0;
+    }
+    const Shard *const shards = m_shards.load(std::memory_order_acquire);
+    iuint64 sum = 0;
+    for (size_t i = 0; i < shardCount; ++i) {
+        sum += shards[i].sum.load(std::memory_order_relaxed);
+    }
+    return sum / valueCount;
+}
+
+iuint64 SignalMetrics::Histogram::percentile(double percentile) const
+{
+    const Shard *const shards = m_shards.load(std::memory_order_acquire);
+    if (!shards) {
+        return 0;
+    }
+    iuint64 buckets[bucketCount];
+    iuint64 valueCount = 0;
+    for (size_t j = 0; j < bucketCount; ++j) {
+        buckets[j] = 0;
+        for (size_t i = 0; i < shardCount; ++i) {
+            buckets[j] += shards[i].buckets[j].load(std::memory_order_relaxed);
+        }
+        valueCount += buckets[j];
+    }
+    if (!valueCount) {
+        return 0;
+    }
+    iuint64 rank = (iuint64) (percentile / 100.0 * valueCount + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    } else if (rank > valueCount) {
+        rank = valueCount;
+    }
+    iuint64 seen = 0;
+    for (size_t j = 0; j < bucketCount; ++j) {
+        seen += buckets[j];
+        if (seen >= rank) {
+            return bucketUpperBound(j);
+        }
+    }
+    return bucketUpperBound(bucketCount - 1);
+}
+
+void SignalMetrics::Histogram::reset()
+{
+    Shard *const shards = m_shards.load(std::memory_order_acquire);
+    if (!shards) {
+        return;
+    }
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards[i].sum.store(0, std::memory_order_relaxed);
+        for (size_t j = 0; j < bucketCount; ++j) {
+            shards[i].buckets[j].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void SignalMetrics::Histogram::add(const Histogram &histogram)
+{
+    const Shard *const other = histogram.m_shards.load(std::memory_order_acquire);
+    if (!other) {
+        return;
+    }
+    Shard *const own = shards();
+    for (size_t i = 0; i < shardCount; ++i) {
+        own[i].sum.fetch_add(other[i].sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        for (size_t j = 0; j < bucketCount; ++j) {
+            own[i].buckets[j].fetch_add(other[i].buckets[j].load(std::memory_order_relaxed),
+                                        std::memory_order_relaxed);
+        }
+    }
+}
+
+SignalMetrics::Histogram::Shard *SignalMetrics::Histogram::shards()
+{
+    Shard *res = m_shards.load(std::memory_order_acquire);
+    if (IDEAL_LIKELY(res != 0)) {
+        return res;
+    }
+    Shard *const shards = new Shard[shardCount];
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards[i].sum.store(0, std::memory_order_relaxed);
+        for (size_t j = 0; j < bucketCount; ++j) {
+            shards[i].buckets[j].store(0, std::memory_order_relaxed);
+        }
+    }
+    // Another thread may have recorded its first value meanwhile
+    if (m_shards.compare_exchange_strong(res, shards, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return shards;
+    }
+    delete[] shards;
+    return res;
+}
+
+size_t SignalMetrics::Histogram::bucketIndex(iuint64 value)
+{
+    // Values below 8 have a bucket each. From there, each power of two 2^e has 8 buckets
+    if (value < 8) {
+        return value;
+    }
+    const size_t exponent = 63 - __builtin_clzll(value);
+    if (exponent >= 40) {
+        return bucketCount - 1;
+    }
+    return (exponent - 2) * 8 + ((value >> (exponent - 3)) & 7);
+}
+
+iuint64 SignalMetrics::Histogram::bucketUpperBound(size_t index)
+{
+    if (index < 8) {
+        return index;
+    }
+    const size_t exponent = index / 8 + 2;
+    const iuint64 lowerBound = (iuint64) (8 + index % 8) << (exponent - 3);
+    return lowerBound + ((iuint64) 1 << (exponent - 3)) - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SignalMetrics::Slot::Slot(const SignalResource *receiver)
+    : m_receiver(receiver)
+    , m_record(0)
+    , m_previous(0)
+    , m_next(0)
+{
+}
+
+SignalMetrics::Slot::~Slot()
+{
+}
+
+const SignalResource *SignalMetrics::Slot::receiver() const
+{
+    return m_receiver;
+}
+
+const SignalMetrics::Histogram &SignalMetrics::Slot::latency() const
+{
+    return m_latency;
+}
+
+const SignalMetrics::Slot *SignalMetrics::Slot::next() const
+{
+    return m_next;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SignalMetrics::Record::Record(const ichar *name, const ichar *signature, const SignalResource *parent)
+    : m_name(name)
+    , m_signature(signature)
+    , m_parent(parent)
+    , m_firstSlot(0)
+    , m_lastSlot(0)
+    , m_previous(0)
+    , m_next(0)
+{
+}
+
+SignalMetrics::Record::~Record()
+{
+}
+
+const ichar *SignalMetrics::Record::name() const
+{
+    return m_name;
+}
+
+const ichar *SignalMetrics::Record::signature() const
+{
+    return m_signature;
+}
+
+const SignalResource *SignalMetrics::Record::parent() const
+{
+    return m_parent;
+}
+
+const SignalMetrics::Histogram &SignalMetrics::Record::latency() const
+{
+    return m_latency;
+}
+
+const SignalMetrics::Histogram &SignalMetrics::Record::disconnectedLatency() const
+{
+    return m_disconnectedLatency;
+}
+
+const SignalMetrics::Slot *SignalMetrics::Record::firstSlot() const
+{
+    return m_firstSlot;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void dumpLatencyColumns(std::ostream &stream, const SignalMetrics::Histogram &latency)
+{
+    stream << std::setw(12) << latency.count()
+           << std::setw(12) << latency.mean()
+           << std::setw(12) << latency.percentile(50)
+           << std::setw(12) << latency.percentile(99)
+           << std::setw(12) << latency.percentile(100) << std::endl;
+}
+
+static void dumpLatencyJson(std::ostream &stream, const SignalMetrics::Histogram &latency)
+{
+    stream << "{\"mean\":" << latency.mean()
+           << ",\"p50\":" << latency.percentile(50)
+           << ",\"p90\":" << latency.percentile(90)
+           << ",\"p99\":" << latency.percentile(99)
+           << ",\"p999\":" << latency.percentile(99.9)
+           << ",\"max\":" << latency.percentile(100) << "}";
+}
+
+/**
+  * @internal
+  *
+  * Names and signatures come from IDEAL_SIGNAL_INIT, so only quotes and backslashes are escaped.
+  */
+static void dumpJsonString(std::ostream &stream, const ichar *str)
+{
+    stream << '"';
+    for (; *str; ++str) {
+        if (*str == '"' || *str == '\\') {
+            stream << '\\';
+        }
+        stream << *str;
+    }
+    stream << '"';
+}
+
+void SignalMetrics::dump(std::ostream &stream, Format format)
+{
+    ContextMutexLocker cml(registryMutex());
+    const std::ios_base::fmtflags flags = stream.flags();
+    if (format == Table) {
+        stream << std::left << std::setw(40) << "signal / slot" << std::right
+               << std::setw(12) << "calls" << std::setw(12) << "mean (ns)" << std::setw(12) << "p50 (ns)"
+               << std::setw(12) << "p99 (ns)" << std::setw(12) << "max (ns)" << std::endl;
+        for (const Record *record = firstRecord(); record; record = record->m_next) {
+            std::ostringstream signal;
+            signal << record->m_parent << " " << record->m_name << "(" << record->m_signature << ")";
+            stream << std::left << std::setw(40) << signal.str() << std::right;
+            dumpLatencyColumns(stream, record->m_latency);
+            for (const Slot *slot = record->m_firstSlot; slot; slot = slot->m_next) {
+                std::ostringstream receiver;
+                receiver << "  -> " << slot->m_receiver;
+                stream << std::left << std::setw(40) << receiver.str() << std::right;
+                dumpLatencyColumns(stream, slot->m_latency);
+            }
+            if (record->m_disconnectedLatency.count()) {
+                stream << std::left << std::setw(40) << "  -> (disconnected)" << std::right;
+                dumpLatencyColumns(stream, record->m_disconnectedLatency);
+            }
+        }
+    } else {
+        stream << "[";
+        for (const Record *record = firstRecord(); record; record = record->m_next) {
+            stream << "{\"name\":";
+            dumpJsonString(stream, record->m_name);
+            stream << ",\"signature\":";
+            dumpJsonString(stream, record->m_signature);
+            stream << ",\"parent\":\"" << record->m_parent << "\",\"emits\":" << record->m_latency.count()
+                   << ",\"latency\":";
+            dumpLatencyJson(stream, record->m_latency);
+            stream << ",\"slots\":[";
+            for (const Slot *slot = record->m_firstSlot; slot; slot = slot->m_next) {
+                stream << "{\"receiver\":\"" << slot->m_receiver << "\",\"calls\":" << slot->m_latency.count()
+                       << ",\"latency\":";
+                dumpLatencyJson(stream, slot->m_latency);
+                stream << (slot->m_next ? "}," : "}");
+            }
+            stream << "],\"disconnectedCalls\":" << record->m_disconnectedLatency.count()
+                   << ",\"disconnectedLatency\":";
+            dumpLatencyJson(stream, record->m_disconnectedLatency);
+            stream << (record->m_next ? "}," : "}");
+        }
+        stream << "]" << std::endl;
+    }
+    stream.flags(flags);
+}
+
+void SignalMetrics::reset()
+{
+    ContextMutexLocker cml(registryMutex());
+    for (Record *record = firstRecord(); record; record = record->m_next) {
+        record->m_latency.reset();
+        record->m_disconnectedLatency.reset();
+        for (Slot *slot = record->m_firstSlot; slot; slot = slot->m_next) {
+            slot->m_latency.reset();
+        }
+    }
+}
+
+iuint64 SignalMetrics::now()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (iuint64) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+SignalMetrics::Record *SignalMetrics::registerSignal(const ichar *name, const ichar *signature,
+                                                     const SignalResource *parent)
+{
+    Record *const record = new Record(name, signature, parent);
+    ContextMutexLocker cml(registryMutex());
+    record->m_next = firstRecord();
+    if (record->m_next) {
+        record->m_next->m_previous = record;
+    }
+    firstRecord() = record;
+    return record;
+}
+
+void SignalMetrics::unregisterSignal(Record *record)
+{
+    {
+        ContextMutexLocker cml(registryMutex());
+        if (record->m_previous) {
+            record->m_previous->m_next = record->m_next;
+        } else {
+            firstRecord() = record->m_next;
+        }
+        if (record->m_next) {
+            record->m_next->m_previous = record->m_previous;
+        }
+        // The slots belong to their connections, which can outlive the signal
+        Slot *slot = record->m_firstSlot;
+        while (slot) {
+            Slot *const next = slot->m_next;
+            slot->m_record = 0;
+            slot->m_previous = 0;
+            slot->m_next = 0;
+            slot = next;
+        }
+    }
+    delete record;
+}
+
+SignalMetrics::Slot *SignalMetrics::registerSlot(Record *record, const SignalResource *receiver)
+{
+    Slot *const slot = new Slot(receiver);
+    ContextMutexLocker cml(registryMutex());
+    slot->m_record = record;
+    slot->m_previous = record->m_lastSlot;
+    if (record->m_lastSlot) {
+        record->m_lastSlot->m_next = slot;
+    } else {
+        record->m_firstSlot = slot;
+    }
+    record->m_lastSlot = slot;
+    return slot;
+}
+
+void SignalMetrics::unregisterSlot(Slot *slot)
+{
+    {
+        ContextMutexLocker cml(registryMutex());
+        Record *const record = slot->m_record;
+        if (record) {
+            record->m_disconnectedLatency.add(slot->m_latency);
+            if (slot->m_previous) {
+                slot->m_previous->m_next = slot->m_next;
+            } else {
+                record->m_firstSlot = slot->m_next;
+            }
+            if (slot->m_next) {
+                slot->m_next->m_previous = slot->m_previous;
+            } else {
+                record->m_lastSlot = slot->m_previous;
+            }
+        }
+    }
+    delete slot;
+}
+
+size_t SignalMetrics::shard()
+{
+    static std::atomic<size_t> nextShard(0);
+    static __thread size_t threadShard = (size_t) -1;
+    if (IDEAL_UNLIKELY(threadShard == (size_t) -1)) {
+        threadShard = nextShard.fetch_add(1, std::memory_order_relaxed) % Histogram::shardCount;
+    }
+    return threadShard;
+}
+
+}
+
+#endif //IDEAL_SIGNAL_METRICS
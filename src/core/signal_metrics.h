@@ -0,0 +1,264 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SIGNAL_METRICS_H
+#define SIGNAL_METRICS_H
+
+#include <ideal_export.h>
+
+#ifdef IDEAL_SIGNAL_METRICS
+
+#include <atomic>
+
+namespace IdealCore {
+
+class SignalResource;
+
+/**
+  * @class SignalMetrics signal_metrics.h core/signal_metrics.h
+  *
+  * Emission metrics of all signals, available when the library is configured with
+  * --enable-signal-metrics (IDEAL_SIGNAL_METRICS is defined in ideal_conf.h). Otherwise none of this
+  * is compiled and emitting a signal costs exactly the same as before.
+  *
+  * Each signal keeps a Record with its name and signature, the number of emissions and a histogram
+  * of their latencies. Each connection keeps the number of calls of its slot and a histogram of
+  * their latencies, which are added to the signal's disconnected latency once the connection is
+  * gone. For queued connections this is the time to post the emission:
+  *
+  * @code
+  * SignalMetrics::dump(std::cout, SignalMetrics::Table);
+  * @endcode
+  *
+  * @note Recording takes two reads of a monotonic clock and a few relaxed atomic additions on
+  *       counters of the shard of the calling thread, so threads emitting the same signal rarely
+  *       contend.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT SignalMetrics
+{
+public:
+    enum Format {
+        Table = 0,  ///< One line per signal and per slot, with aligned columns.
+        Json        ///< A JSON array with an object per signal.
+    };
+
+    class Record;
+
+    /**
+      * @class Histogram signal_metrics.h core/signal_metrics.h
+      *
+      * Counts values in nanoseconds in buckets of logarithmic size, as HDR histograms do: each
+      * power of two is split in 8 buckets, so the value reported for a percentile is at most 12.5%
+      * larger than the real one. Values up to 2^40 nanoseconds (about 18 minutes) are counted in
+      * their own bucket. Threads are spread round robin over a few shards, which are summed when
+      * read. Shards are allocated when the first value is recorded, so a histogram that never
+      * recorded anything only takes a pointer.
+      */
+    class IDEAL_EXPORT Histogram
+    {
+    public:
+        Histogram();
+        ~Histogram();
+
+        void record(iuint64 value);
+
+        /**
+          * @return The number of values recorded.
+          */
+        iuint64 count() const;
+
+        /**
+          * @return The mean of the values recorded. 0 if there are none.
+          */
+        iuint64 mean() const;
+
+        /**
+          * @return The upper bound of the bucket holding the value below which @p percentile percent
+          *         of the values are. 0 if there are none.
+          */
+        iuint64 percentile(double percentile) const;
+
+        /**
+          * Forgets all values recorded. Values recorded at the same time may be lost.
+          */
+        void reset();
+
+        static const size_t shardCount = 4;
+        static const size_t bucketCount = 304;
+
+    private:
+        friend class SignalMetrics;
+
+        Histogram(const Histogram &histogram);
+        Histogram &operator=(const Histogram &histogram);
+
+        /**
+          * Adds the values recorded by @p histogram to this one.
+          */
+        void add(const Histogram &histogram);
+
+        static size_t bucketIndex(iuint64 value);
+        static iuint64 bucketUpperBound(size_t index);
+
+        /**
+          * Padded, so no cache line holds counters of two shards.
+          */
+        struct Shard
+        {
+            std::atomic<iuint64> sum;
+            std::atomic<iuint64> buckets[bucketCount];
+            ichar                padding[64];
+        };
+
+        /**
+          * @return The shards, allocated if no value was recorded yet.
+          */
+        Shard *shards();
+
+        std::atomic<Shard*> m_shards;
+    };
+
+    /**
+      * @class Slot signal_metrics.h core/signal_metrics.h
+      *
+      * The metrics of one connection. It belongs to the connection, and is removed from its signal
+      * when the connection is destroyed.
+      */
+    class IDEAL_EXPORT Slot
+    {
+    public:
+        /**
+          * @return The receiver of this connection. 0 for functors.
+          */
+        const SignalResource *receiver() const;
+
+        /**
+          * @return The call latencies of this slot. Its count is the number of calls.
+          */
+        const Histogram &latency() const;
+
+        /**
+          * @return The next connection of the same signal. 0 if this is the last one.
+          */
+        const Slot *next() const;
+
+    private:
+        friend class SignalMetrics;
+        friend class SignalBase;
+
+        Slot(const SignalResource *receiver);
+        ~Slot();
+
+        const SignalResource *const m_receiver;
+        Histogram                   m_latency;
+        // 0 once the signal is destroyed
+        Record                     *m_record;
+        Slot                       *m_previous;
+        Slot                       *m_next;
+    };
+
+    /**
+      * @class Record signal_metrics.h core/signal_metrics.h
+      *
+      * The metrics of one signal.
+      */
+    class IDEAL_EXPORT Record
+    {
+    public:
+        const ichar *name() const;
+        const ichar *signature() const;
+        const SignalResource *parent() const;
+
+        /**
+          * @return The emission latencies of this signal. Its count is the number of emissions.
+          *         Blocked emissions are not counted.
+          */
+        const Histogram &latency() const;
+
+        /**
+          * @return The call latencies of all connections of this signal that were destroyed.
+          */
+        const Histogram &disconnectedLatency() const;
+
+        /**
+          * @return The first connection of this signal that was not destroyed. 0 if there are none.
+          */
+        const Slot *firstSlot() const;
+
+    private:
+        friend class SignalMetrics;
+        friend class SignalBase;
+
+        Record(const ichar *name, const ichar *signature, const SignalResource *parent);
+        ~Record();
+
+        const ichar          *const m_name;
+        const ichar          *const m_signature;
+        const SignalResource *const m_parent;
+        Histogram                   m_latency;
+        Histogram                   m_disconnectedLatency;
+        Slot                       *m_firstSlot;
+        Slot                       *m_lastSlot;
+        Record                     *m_previous;
+        Record                     *m_next;
+    };
+
+    /**
+      * Writes the metrics of all existing signals to @p stream in @p format.
+      */
+    static void dump(std::ostream &stream, Format format = Table);
+
+    /**
+      * Resets the histograms of all existing signals and their connections.
+      */
+    static void reset();
+
+    /**
+      * @return The current time of a monotonic clock, in nanoseconds.
+      */
+    static iuint64 now();
+
+private:
+    friend class SignalBase;
+    friend class CallbackDummy;
+
+    static Record *registerSignal(const ichar *name, const ichar *signature, const SignalResource *parent);
+    static void unregisterSignal(Record *record);
+    static Slot *registerSlot(Record *record, const SignalResource *receiver);
+
+    /**
+      * Called when the connection of @p slot is destroyed. Its calls are added to the disconnected
+      * latency of its signal, if it still exists, and it is deleted.
+      */
+    static void unregisterSlot(Slot *slot);
+
+    /**
+      * @return The shard of the calling thread.
+      */
+    static size_t shard();
+};
+
+}
+
+#endif //IDEAL_SIGNAL_METRICS
+
+#endif //SIGNAL_METRICS_H
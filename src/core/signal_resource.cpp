@@ -0,0 +1,145 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "signal_resource.h"
+#include "ideal_signal.h"
+
+namespace IdealCore {
+
+class SignalResource::DeferredDeletion
+{
+public:
+    SignalResource   *m_resource;
+    DeferredDeletion *m_next;
+};
+
+__thread SignalResource::DeferredDeletion *SignalResource::m_deferredDeletions = 0;
+__thread size_t SignalResource::m_deferredDeletionDepth = 0;
+
+SignalResource::SignalResource()
+    : m_mutex(Mutex::Recursive)
+    , m_emitBlocked(false)
+    , m_signalsBlocked(false)
+    , m_weakReference(0)
+{
+}
+
+SignalResource::~SignalResource()
+{
+    WeakReference *const weakReference = m_weakReference.load(std::memory_order_acquire);
+    if (weakReference) {
+        weakReference->m_alive.store(false, std::memory_order_release);
+        weakReference->deref();
+    }
+}
+
+void SignalResource::signalCreated(const SignalBase *signal)
+{
+    IDEAL_UNUSED(signal);
+}
+
+void SignalResource::signalConnected(const SignalBase *signal)
+{
+    IDEAL_UNUSED(signal);
+}
+
+void SignalResource::signalDisconnected(const SignalBase *signal)
+{
+    IDEAL_UNUSED(signal);
+}
+
+List<const SignalBase*> SignalResource::signals() const
+{
+    return List<const SignalBase*>();
+}
+
+void SignalResource::setEmitBlocked(bool emitBlocked)
+{
+    m_emitBlocked.store(emitBlocked, std::memory_order_release);
+}
+
+void SignalResource::setSignalsBlocked(bool signalsBlocked)
+{
+    m_signalsBlocked.store(signalsBlocked, std::memory_order_release);
+}
+
+WeakReference *SignalResource::weakReference() const
+{
+    WeakReference *res = m_weakReference.load(std::memory_order_acquire);
+    if (!res) {
+        WeakReference *const weakReference = new WeakReference;
+        if (m_weakReference.compare_exchange_strong(res, weakReference, std::memory_order_acq_rel)) {
+            res = weakReference;
+        } else {
+            delete weakReference;
+        }
+    }
+    res->ref();
+    return res;
+}
+
+void SignalResource::deleteLater()
+{
+    if (!m_deferredDeletionDepth && !SignalBase::EmitFrame::current()) {
+        delete this;
+        return;
+    }
+    DeferredDeletion *const deferredDeletion = new DeferredDeletion;
+    deferredDeletion->m_resource = this;
+    deferredDeletion->m_next = m_deferredDeletions;
+    m_deferredDeletions = deferredDeletion;
+}
+
+void SignalResource::deleteDeferred()
+{
+    if (m_deferredDeletionDepth || SignalBase::EmitFrame::current()) {
+        return;
+    }
+    // Deleting a resource can defer more deletions, which are picked on the next round
+    while (m_deferredDeletions) {
+        DeferredDeletion *deferredDeletion = 0;
+        while (m_deferredDeletions) {
+            DeferredDeletion *const next = m_deferredDeletions->m_next;
+            m_deferredDeletions->m_next = deferredDeletion;
+            deferredDeletion = m_deferredDeletions;
+            m_deferredDeletions = next;
+        }
+        while (deferredDeletion) {
+            DeferredDeletion *const next = deferredDeletion->m_next;
+            delete deferredDeletion->m_resource;
+            delete deferredDeletion;
+            deferredDeletion = next;
+        }
+    }
+}
+
+SignalResource::DeferredDeletionScope::DeferredDeletionScope()
+{
+    ++m_deferredDeletionDepth;
+}
+
+SignalResource::DeferredDeletionScope::~DeferredDeletionScope()
+{
+    if (!--m_deferredDeletionDepth && IDEAL_UNLIKELY(m_deferredDeletions != 0)) {
+        deleteDeferred();
+    }
+}
+
+}
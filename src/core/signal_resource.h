@@ -25,10 +25,48 @@
 #include <core/list.h>
 #include <core/mutex.h>
 
+#include <atomic>
+
 namespace IdealCore {
 
 class SignalBase;
 
+/**
+  * @internal
+  *
+  * Shared between a signal resource and the safe pointers to it. It outlives the resource while
+  * there are safe pointers, so they can check whether the resource still exists with a single load.
+  */
+class IDEAL_EXPORT WeakReference
+{
+public:
+    WeakReference()
+        : m_alive(true)
+        , m_refs(1)
+    {
+    }
+
+    bool isAlive() const
+    {
+        return m_alive.load(std::memory_order_acquire);
+    }
+
+    void ref()
+    {
+        m_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void deref()
+    {
+        if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    std::atomic<bool>   m_alive;
+    std::atomic<size_t> m_refs;
+};
+
 /**
   * @internal
   */
@@ -74,11 +112,89 @@ public:
 
     /**
       * Returns whether emit() is blocked for this object or not.
+      *
+      * @note This is checked on every emission, so it is a single atomic load and it is not
+      *       virtual. Subclasses that need to decide when emit() is blocked override
+      *       setEmitBlocked() instead.
+      */
+    bool isEmitBlocked() const
+    {
+        return m_emitBlocked.load(std::memory_order_acquire);
+    }
+
+    /**
+      * Returns whether slots of this object are blocked, so connected signals are not delivered to
+      * it.
+      *
+      * @note This is checked on every slot call, so it is a single atomic load and it is not
+      *       virtual. Subclasses override setSignalsBlocked() instead.
+      */
+    bool areSignalsBlocked() const
+    {
+        return m_signalsBlocked.load(std::memory_order_acquire);
+    }
+
+    /**
+      * Sets whether emit() is blocked for this object. Reimplementations can change or react to
+      * @p emitBlocked, and have to call this implementation, which stores what isEmitBlocked()
+      * returns.
       */
-    virtual bool isEmitBlocked() const;
+    virtual void setEmitBlocked(bool emitBlocked);
+
+    /**
+      * Sets whether slots of this object are blocked. Reimplementations can change or react to
+      * @p signalsBlocked, and have to call this implementation, which stores what
+      * areSignalsBlocked() returns.
+      */
+    virtual void setSignalsBlocked(bool signalsBlocked);
+
+    /**
+      * Deletes this resource once the emissions in progress on the calling thread and the event
+      * loop iteration it is dispatching, if any, are done. If there are none, it is deleted right
+      * away. Resources deferred this way on the same thread are deleted in the order this was
+      * called.
+      *
+      * @note Has to be called once at most, and the resource has to be allocated with new.
+      */
+    void deleteLater();
+
+    /**
+      * @internal
+      *
+      * @return The weak reference to this resource, created on the first call. The caller owns a
+      *         reference to it. It stops being alive when this resource is destroyed.
+      */
+    WeakReference *weakReference() const;
+
+    /**
+      * @internal
+      *
+      * While a scope exists on a thread, deleteLater() defers the deletion on that thread. The
+      * deferred resources are deleted once the outermost scope and emission end.
+      */
+    class IDEAL_EXPORT DeferredDeletionScope
+    {
+    public:
+        DeferredDeletionScope();
+        ~DeferredDeletionScope();
+    };
 
 private:
-    Mutex m_mutex;
+    class DeferredDeletion;
+
+    /**
+      * Deletes the resources deferred on the calling thread, unless a scope or an emission is
+      * still in progress on it.
+      */
+    static void deleteDeferred();
+
+    static __thread DeferredDeletion *m_deferredDeletions;
+    static __thread size_t            m_deferredDeletionDepth;
+
+    Mutex                                m_mutex;
+    std::atomic<bool>                    m_emitBlocked;
+    std::atomic<bool>                    m_signalsBlocked;
+    mutable std::atomic<WeakReference*>  m_weakReference;
 };
 
 }
@@ -0,0 +1,251 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "signal_trace.h"
+
+#include <iomanip>
+#include <time.h>
+#include <unistd.h>
+
+namespace IdealCore {
+
+std::atomic<bool> SignalTrace::m_enabled(false);
+
+/**
+  * @internal
+  *
+  * The events of one thread. Only that thread writes, and readers detect the events overwritten
+  * while they read them as in a sequence lock: m_writing is advanced before an event is written and
+  * m_head after it is.
+  */
+class SignalTrace::Buffer
+{
+public:
+    Buffer(iuint32 thread);
+
+    void record(Kind kind, const ichar *signalName, const void *receiver, iuint64 start, iuint64 end);
+    void exportEvents(std::ostream &stream, pid_t pid, bool &first) const;
+    void clear();
+
+    /**
+      * @return The buffer of the calling thread, which is created the first time.
+      */
+    static Buffer *current();
+
+    static Mutex &buffersMutex();
+    static Buffer *&firstBuffer();
+
+    struct Event
+    {
+        std::atomic<iuint64>       start;
+        std::atomic<iuint64>       end;
+        std::atomic<const ichar*>  signalName;
+        std::atomic<const void*>   receiver;
+        std::atomic<iuint32>       kind;
+    };
+
+    /**
+      * Flags the buffer of a thread as finished when the thread exits.
+      */
+    class Owner
+    {
+    public:
+        Owner()
+            : m_buffer(0)
+        {
+        }
+
+        ~Owner()
+        {
+            if (m_buffer) {
+                m_buffer->m_finished.store(true, std::memory_order_release);
+            }
+        }
+
+        Buffer *m_buffer;
+    };
+
+    std::atomic<iuint64>  m_head;
+    std::atomic<iuint64>  m_writing;
+    std::atomic<bool>     m_finished;
+    const iuint32         m_thread;
+    Buffer               *m_next;
+    Event                 m_events[bufferCapacity];
+};
+
+SignalTrace::Buffer::Buffer(iuint32 thread)
+    : m_head(0)
+    , m_writing(0)
+    , m_finished(false)
+    , m_thread(thread)
+    , m_next(0)
+{
+}
+
+void SignalTrace::Buffer::record(Kind kind, const ichar *signalName, const void *receiver, iuint64 start, iuint64 end)
+{
+    const iuint64 head = m_head.load(std::memory_order_relaxed);
+    m_writing.store(head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    Event &event = m_events[head % bufferCapacity];
+    event.start.store(start, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    event.signalName.store(signalName, std::memory_order_relaxed);
+    event.receiver.store(receiver, std::memory_order_relaxed);
+    event.kind.store(kind, std::memory_order_relaxed);
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+void SignalTrace::Buffer::exportEvents(std::ostream &stream, pid_t pid, bool &first) const
+{
+    static const ichar *const kindName[] = { "emission", "call", "queued call" };
+    struct Copy
+    {
+        iuint64       start;
+        iuint64       end;
+        const ichar  *signalName;
+        const void   *receiver;
+        iuint32       kind;
+    };
+    const iuint64 head = m_head.load(std::memory_order_acquire);
+    const iuint64 begin = head > bufferCapacity ? head - bufferCapacity : 0;
+    const size_t count = head - begin;
+    Copy *const events = new Copy[count];
+    for (size_t i = 0; i < count; ++i) {
+        const Event &event = m_events[(begin + i) % bufferCapacity];
+        events[i].start = event.start.load(std::memory_order_relaxed);
+        events[i].end = event.end.load(std::memory_order_relaxed);
+        events[i].signalName = event.signalName.load(std::memory_order_relaxed);
+        events[i].receiver = event.receiver.load(std::memory_order_relaxed);
+        events[i].kind = event.kind.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // Events up to the one being written now minus the capacity could have been overwritten
+    const iuint64 writing = m_writing.load(std::memory_order_relaxed);
+    const iuint64 firstValid = writing > bufferCapacity ? writing - bufferCapacity : 0;
+    for (size_t i = firstValid > begin ? firstValid - begin : 0; i < count; ++i) {
+        const Copy &event = events[i];
+        const iuint64 duration = event.end - event.start;
+        stream << (first ? "\n" : ",\n");
+        first = false;
+        stream << "{\"name\":\"" << (event.signalName ? event.signalName : "destroyed")
+               << "\",\"cat\":\"" << kindName[event.kind]
+               << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << m_thread
+               << ",\"ts\":" << event.start / 1000 << "." << std::setw(3) << std::setfill('0') << event.start % 1000
+               << ",\"dur\":" << duration / 1000 << "." << std::setw(3) << std::setfill('0') << duration % 1000
+               << ",\"args\":{\"receiver\":\"" << event.receiver << "\"}}";
+    }
+    delete[] events;
+}
+
+void SignalTrace::Buffer::clear()
+{
+    m_head.store(0, std::memory_order_relaxed);
+    m_writing.store(0, std::memory_order_relaxed);
+}
+
+SignalTrace::Buffer *SignalTrace::Buffer::current()
+{
+    static __thread Buffer *currentBuffer = 0;
+    if (IDEAL_LIKELY(currentBuffer != 0)) {
+        return currentBuffer;
+    }
+    static thread_local Owner currentBufferOwner;
+    ContextMutexLocker cml(buffersMutex());
+    iuint32 thread = 1;
+    for (Buffer *buffer = firstBuffer(); buffer; buffer = buffer->m_next) {
+        if (buffer->m_thread >= thread) {
+            thread = buffer->m_thread + 1;
+        }
+    }
+    currentBuffer = new Buffer(thread);
+    currentBuffer->m_next = firstBuffer();
+    firstBuffer() = currentBuffer;
+    currentBufferOwner.m_buffer = currentBuffer;
+    return currentBuffer;
+}
+
+Mutex &SignalTrace::Buffer::buffersMutex()
+{
+    static Mutex mutex;
+    return mutex;
+}
+
+SignalTrace::Buffer *&SignalTrace::Buffer::firstBuffer()
+{
+    static Buffer *buffer = 0;
+    return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SignalTrace::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void SignalTrace::record(Kind kind, const ichar *signalName, const void *receiver, iuint64 start)
+{
+    const iuint64 end = now();
+    Buffer::current()->record(kind, signalName, receiver, start, end);
+}
+
+void SignalTrace::exportChromeTrace(std::ostream &stream)
+{
+    const std::ios_base::fmtflags flags = stream.flags();
+    const ichar fill = stream.fill();
+    const pid_t pid = getpid();
+    bool first = true;
+    stream << "{\"traceEvents\":[";
+    {
+        ContextMutexLocker cml(Buffer::buffersMutex());
+        for (const Buffer *buffer = Buffer::firstBuffer(); buffer; buffer = buffer->m_next) {
+            buffer->exportEvents(stream, pid, first);
+        }
+    }
+    stream << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+    stream.flags(flags);
+    stream.fill(fill);
+}
+
+void SignalTrace::clear()
+{
+    ContextMutexLocker cml(Buffer::buffersMutex());
+    Buffer **buffer = &Buffer::firstBuffer();
+    while (*buffer) {
+        Buffer *const curr = *buffer;
+        if (curr->m_finished.load(std::memory_order_acquire)) {
+            *buffer = curr->m_next;
+            delete curr;
+        } else {
+            curr->clear();
+            buffer = &curr->m_next;
+        }
+    }
+}
+
+iuint64 SignalTrace::now()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (iuint64) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SIGNAL_TRACE_H
+#define SIGNAL_TRACE_H
+
+#include <ideal_export.h>
+
+#include <atomic>
+
+namespace IdealCore {
+
+/**
+  * @class SignalTrace signal_trace.h core/signal_trace.h
+  *
+  * A timeline of signal emissions and slot calls on all threads, to find out where time goes or why
+  * an event loop stalls. While enabled, every emission, every slot called from it and every slot
+  * called from an event loop through a queued connection is recorded with its start time, its
+  * duration, the name of the signal and the receiver:
+  *
+  * @code
+  * SignalTrace::setEnabled(true);
+  * ...
+  * std::ofstream file("trace.json");
+  * SignalTrace::exportChromeTrace(file);
+  * @endcode
+  *
+  * The result can be loaded in chrome://tracing or Perfetto.
+  *
+  * Each thread records in its own ring buffer of bufferCapacity events, without locks and without
+  * allocating after the first event, so only the newest events of each thread are kept. Buffers
+  * of threads that finished are kept until clear() is called.
+  *
+  * @note While disabled, an emission costs a single relaxed load more. While enabled, each event
+  *       costs two reads of the monotonic clock and a few stores to the buffer of the thread.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT SignalTrace
+{
+public:
+    enum Kind {
+        Emission = 0,   ///< A whole emission, on the emitting thread.
+        Call,           ///< A slot called from an emission.
+        QueuedCall      ///< A slot called from an event loop through a queued connection.
+    };
+
+    static const size_t bufferCapacity = 4096;
+
+    static void setEnabled(bool enabled);
+
+    static bool isEnabled()
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+      * Records an event of @p kind that started at @p start (see now()) and ends now.
+      */
+    static void record(Kind kind, const ichar *signalName, const void *receiver, iuint64 start);
+
+    /**
+      * Writes the events recorded in Chrome trace event format, ordered by thread. Can be called
+      * while other threads keep recording: events overwritten while they are being read are
+      * left out.
+      */
+    static void exportChromeTrace(std::ostream &stream);
+
+    /**
+      * Forgets all events recorded, and frees the buffers of threads that finished. Must not be
+      * called while other threads are recording.
+      */
+    static void clear();
+
+    /**
+      * @return The current time of a monotonic clock, in nanoseconds.
+      */
+    static iuint64 now();
+
+private:
+    class Buffer;
+
+    static std::atomic<bool> m_enabled;
+};
+
+}
+
+#endif //SIGNAL_TRACE_H
@@ -0,0 +1,250 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef STATIC_SIGNAL_H
+#define STATIC_SIGNAL_H
+
+#include <ideal_export.h>
+#include <core/ideal_signal.h>
+
+namespace IdealCore {
+
+/**
+  * @internal
+  *
+  * @return Whether the slot handled the emission (see Signal::emitUntilHandled()).
+  */
+template <typename Receiver, typename Result, typename... Arg, typename... Param>
+inline bool invokeStaticSlot(Result (Receiver::*member)(Arg...), SignalResource *parent, const Param&... param)
+{
+    static_assert(std::is_base_of<SignalResource, Receiver>::value, "static slots have to be members of a SignalResource");
+    return SlotResult<Result>::callMember(static_cast<Receiver*>(parent), member, param...);
+}
+
+/**
+  * @internal
+  */
+template <typename Receiver, typename Result, typename... Arg, typename... Param>
+inline bool invokeStaticSlot(Result (Receiver::*member)(Arg...) const, SignalResource *parent, const Param&... param)
+{
+    static_assert(std::is_base_of<SignalResource, Receiver>::value, "static slots have to be members of a SignalResource");
+    return SlotResult<Result>::callMember(static_cast<const Receiver*>(parent), member, param...);
+}
+
+/**
+  * @internal
+  */
+template <typename Result, typename... Arg, typename... Param>
+inline bool invokeStaticSlot(Result (*function)(Arg...), SignalResource *, const Param&... param)
+{
+    return SlotResult<Result>::callFunction(function, param...);
+}
+
+/**
+  * @internal
+  *
+  * Whether @p Slot can be called on an object of class @p Owner: free functions always can, members
+  * only if @p Owner is of their class.
+  */
+template <typename Owner, typename Slot>
+struct IsStaticSlotOf
+    : std::true_type
+{
+};
+
+template <typename Owner, typename Receiver, typename Result, typename... Arg>
+struct IsStaticSlotOf<Owner, Result (Receiver::*)(Arg...)>
+    : std::is_base_of<Receiver, Owner>
+{
+};
+
+template <typename Owner, typename Receiver, typename Result, typename... Arg>
+struct IsStaticSlotOf<Owner, Result (Receiver::*)(Arg...) const>
+    : std::is_base_of<Receiver, Owner>
+{
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * A slot known at compile time: a member of the class owning the signal, or a free function.
+  * Declared with IDEAL_STATIC_SLOT.
+  */
+template <typename Slot, Slot slot>
+struct StaticSlot
+{
+    typedef Slot Type;
+
+    template <typename... Param>
+    static inline bool call(SignalResource *parent, const Param&... param)
+    {
+        return invokeStaticSlot(slot, parent, param...);
+    }
+};
+
+/**
+  * @internal
+  *
+  * A list of slots of a StaticSignal. The empty list is defined in ideal_signal.h.
+  */
+template <typename First, typename... Rest>
+struct StaticSlotList<First, Rest...>
+{
+    /**
+      * Whether all slots can be called on an object of class @p Owner.
+      */
+    template <typename Owner>
+    struct AcceptsOwner
+        : std::integral_constant<bool, IsStaticSlotOf<Owner, typename First::Type>::value &&
+                                       StaticSlotList<Rest...>::template AcceptsOwner<Owner>::value>
+    {
+    };
+
+    template <typename... Param>
+    static inline void call(SignalResource *parent, const Param&... param)
+    {
+        First::call(parent, param...);
+        StaticSlotList<Rest...>::call(parent, param...);
+    }
+
+    /**
+      * Stops at the first slot that handles the emission.
+      */
+    template <typename... Param>
+    static inline bool callHandled(SignalResource *parent, const Param&... param)
+    {
+        return First::call(parent, param...) || StaticSlotList<Rest...>::callHandled(parent, param...);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * All the static slots of a signal behind one callback, for the emissions that only see the
+  * connection list: forwards from other signals, emitBatch() and parallel emissions. emit() and
+  * emitUntilHandled() call the slots directly instead. The slots are called directly from here as
+  * well, so the compiler can inline them.
+  */
+template <typename Slots, typename... Param>
+class CallbackStaticSlots
+    : public CallbackBase<Param...>
+{
+public:
+    CallbackStaticSlots(SignalResource *parent)
+    {
+        this->m_receiver = parent;
+    }
+
+    virtual void operator()(const Param&... param)
+    {
+        if (this->m_receiver->areSignalsBlocked()) {
+            return;
+        }
+        Slots::call(this->m_receiver, param...);
+    }
+
+    virtual bool callHandled(const Param&... param)
+    {
+        if (this->m_receiver->areSignalsBlocked()) {
+            return false;
+        }
+        return Slots::callHandled(this->m_receiver, param...);
+    }
+
+    virtual bool callBatch(const Vector<std::tuple<Param...> > &batch)
+    {
+        if (!this->m_receiver->areSignalsBlocked()) {
+            for (size_t i = 0; i < batch.size(); ++i) {
+                callSlots(batch[i], typename MakeIndexList<sizeof...(Param)>::Type());
+            }
+        }
+        return true;
+    }
+
+private:
+    template <size_t... Index>
+    void callSlots(const std::tuple<Param...> &param, IndexList<Index...>)
+    {
+        Slots::call(this->m_receiver, std::get<Index>(param)...);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * A signal whose slots are fixed at compile time. Every emission calls them before the slots
+  * connected at runtime, whether it goes through emit(), emitUntilHandled(), emitBatch(), a parallel
+  * emission or a forward from another signal. It is declared with IDEAL_STATIC_SIGNAL and
+  * initialized with IDEAL_SIGNAL_INIT:
+  *
+  * @code
+  * class MyObject : public Object {
+  * public:
+  *     MyObject() : IDEAL_SIGNAL_INIT(valueChanged, iint32) {}
+  *     void updateCache(const iint32 &value);
+  *
+  *     typedef StaticSlotList<IDEAL_STATIC_SLOT(&MyObject::updateCache)> ValueChangedSlots;
+  *     IDEAL_STATIC_SIGNAL(valueChanged, ValueChangedSlots, iint32);
+  * };
+  * @endcode
+  *
+  * Member slots are called on the object owning the signal, which has to be of the slot's class:
+  * this is checked at compile time. None of the static slots are called while that object has
+  * signals blocked. emit() and emitUntilHandled() call them directly, so without connections made at
+  * runtime an emission costs the calls to the slots, which the compiler can inline, and the checks
+  * for blocking and for the destruction of the signal.
+  *
+  * @note A static slot must not destroy the object owning the signal, as the next static slots
+  *       are called on it. SignalResource::deleteLater() can be used instead.
+  */
+template <typename Slots, typename... Param>
+class StaticSignal
+    : public Signal<Param...>
+{
+public:
+    template <typename Owner>
+    StaticSignal(Owner *parent, const ichar *name, const ichar *signature)
+        : Signal<Param...>(parent, name, signature)
+    {
+        static_assert(Slots::template AcceptsOwner<Owner>::value,
+                      "member static slots have to belong to the class owning the signal");
+        this->setStaticSlots(new CallbackStaticSlots<Slots, Param...>(parent));
+    }
+
+    void emit(const Param&... param) const
+    {
+        this->template callSlots<false, Slots>(param...);
+    }
+
+    bool emitUntilHandled(const Param&... param) const
+    {
+        return this->template callSlots<true, Slots>(param...);
+    }
+};
+
+}
+
+#endif //STATIC_SIGNAL_H
@@ -0,0 +1,101 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "epochTest.h"
+
+#include <core/epoch.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace IdealCore;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(EpochTest);
+
+static std::atomic<iint32> destroyed(0);
+
+static void destroy(void *object)
+{
+    delete static_cast<iint32*>(object);
+    destroyed.fetch_add(1);
+}
+
+void EpochTest::setUp()
+{
+    destroyed.store(0);
+}
+
+void EpochTest::tearDown()
+{
+}
+
+void EpochTest::testRetire()
+{
+    // Without guards, objects are destroyed at once
+    Epoch::retire(new iint32(1), &destroy);
+    CPPUNIT_ASSERT_EQUAL(1, destroyed.load());
+    // Guards of the retiring thread delay destruction until they are gone
+    {
+        Epoch::Guard guard;
+        {
+            Epoch::Guard nestedGuard;
+            Epoch::retire(new iint32(2), &destroy);
+        }
+        Epoch::collect();
+        CPPUNIT_ASSERT_EQUAL(1, destroyed.load());
+    }
+    Epoch::collect();
+    CPPUNIT_ASSERT_EQUAL(2, destroyed.load());
+}
+
+void EpochTest::testGuard()
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool guarded = false;
+    bool release = false;
+    std::thread thread([&] {
+        Epoch::Guard guard;
+        std::unique_lock<std::mutex> lock(mutex);
+        guarded = true;
+        condition.notify_all();
+        condition.wait(lock, [&release] { return release; });
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&guarded] { return guarded; });
+    }
+    // Another thread holding a guard keeps retired objects alive
+    Epoch::retire(new iint32(1), &destroy);
+    Epoch::collect();
+    CPPUNIT_ASSERT_EQUAL(0, destroyed.load());
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        release = true;
+        condition.notify_all();
+    }
+    thread.join();
+    Epoch::synchronize();
+    CPPUNIT_ASSERT_EQUAL(1, destroyed.load());
+}
+
+#include "test.h"
@@ -0,0 +1,144 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "eventLoopTest.h"
+
+#include <core/event_loop.h>
+#include <core/vector.h>
+
+#include <thread>
+#include <unistd.h>
+
+using namespace IdealCore;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(EventLoopTest);
+
+class Watcher
+    : public SignalResource
+{
+public:
+    Watcher(EventLoop &eventLoop)
+        : m_eventLoop(eventLoop)
+        , m_bytes(0)
+        , m_timeouts(0)
+        , m_repeatingTimer(0)
+    {
+    }
+
+    void readData(const iint32 &fileDescriptor)
+    {
+        ichar buffer[16];
+        const ssize_t size = read(fileDescriptor, buffer, sizeof(buffer));
+        if (size > 0) {
+            m_bytes += size;
+        }
+        if (m_bytes == 6) {
+            m_eventLoop.quit();
+        }
+    }
+
+    void timerExpired(const iuint64 &timerId)
+    {
+        m_expired.append(timerId);
+        if (timerId == m_repeatingTimer && ++m_timeouts == 3) {
+            m_eventLoop.stopTimer(m_repeatingTimer);
+            m_eventLoop.quit();
+        }
+    }
+
+    EventLoop       &m_eventLoop;
+    ssize_t          m_bytes;
+    iint32           m_timeouts;
+    iuint64          m_repeatingTimer;
+    Vector<iuint64>  m_expired;
+};
+
+void EventLoopTest::setUp()
+{
+}
+
+void EventLoopTest::tearDown()
+{
+}
+
+void EventLoopTest::testPost()
+{
+    EventLoop eventLoop;
+    iint32 sum = 0;
+    eventLoop.postCallback([&sum] { sum += 1; });
+    eventLoop.postCallback([&sum] { sum *= 10; });
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, eventLoop.processEvents());
+    CPPUNIT_ASSERT_EQUAL(10, sum);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, eventLoop.processEvents());
+
+    std::thread thread([&eventLoop] { eventLoop.exec(); });
+    for (iint32 i = 0; i < 1000; ++i) {
+        eventLoop.postCallback([&sum] { ++sum; });
+    }
+    eventLoop.postCallback([&eventLoop] { eventLoop.quit(); });
+    thread.join();
+    CPPUNIT_ASSERT_EQUAL(1010, sum);
+    CPPUNIT_ASSERT(!eventLoop.isRunning());
+}
+
+void EventLoopTest::testFileDescriptors()
+{
+    EventLoop eventLoop;
+    Watcher watcher(eventLoop);
+    iint32 fileDescriptors[2];
+    CPPUNIT_ASSERT(!pipe(fileDescriptors));
+    eventLoop.readyRead.connect(&watcher, &Watcher::readData);
+    eventLoop.watch(fileDescriptors[0], EventLoop::Read);
+    std::thread thread([&fileDescriptors] {
+        for (iint32 i = 0; i < 3; ++i) {
+            CPPUNIT_ASSERT_EQUAL((ssize_t) 2, write(fileDescriptors[1], "ab", 2));
+            usleep(1000);
+        }
+    });
+    eventLoop.exec();
+    thread.join();
+    CPPUNIT_ASSERT_EQUAL((ssize_t) 6, watcher.m_bytes);
+    eventLoop.unwatch(fileDescriptors[0]);
+    CPPUNIT_ASSERT_EQUAL((ssize_t) 2, write(fileDescriptors[1], "ab", 2));
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, eventLoop.processEvents());
+    close(fileDescriptors[0]);
+    close(fileDescriptors[1]);
+}
+
+void EventLoopTest::testTimers()
+{
+    EventLoop eventLoop;
+    Watcher watcher(eventLoop);
+    eventLoop.timeout.connect(&watcher, &Watcher::timerExpired);
+    const iuint64 singleShot = eventLoop.startTimer(1, true);
+    const iuint64 stopped = eventLoop.startTimer(2, true);
+    watcher.m_repeatingTimer = eventLoop.startTimer(5);
+    eventLoop.stopTimer(stopped);
+    eventLoop.exec();
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, watcher.m_expired.size());
+    CPPUNIT_ASSERT_EQUAL(singleShot, watcher.m_expired[0]);
+    for (size_t i = 1; i < 4; ++i) {
+        CPPUNIT_ASSERT_EQUAL(watcher.m_repeatingTimer, watcher.m_expired[i]);
+    }
+    usleep(10000);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, eventLoop.processEvents());
+}
+
+#include "test.h"
@@ -0,0 +1,181 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "sharedMemoryChannelTest.h"
+
+#include <core/shared_memory_channel.h>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+using namespace IdealCore;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SharedMemoryChannelTest);
+
+class Sender
+    : public SignalResource
+{
+public:
+    Sender()
+        : IDEAL_SIGNAL_INIT(valueChanged, iint32)
+    {
+    }
+
+    IDEAL_SIGNAL(valueChanged, iint32);
+};
+
+class Receiver
+    : public SignalResource
+{
+public:
+    Receiver()
+        : m_sum(0)
+        , m_count(0)
+    {
+    }
+
+    void add(const iint32 &value)
+    {
+        m_sum += value;
+        ++m_count;
+    }
+
+    iint32 m_sum;
+    iint32 m_count;
+};
+
+void SharedMemoryChannelTest::setUp()
+{
+}
+
+void SharedMemoryChannelTest::tearDown()
+{
+}
+
+void SharedMemoryChannelTest::testSendReceive()
+{
+    SharedMemoryChannel channel(sizeof(iint32), 3);
+    CPPUNIT_ASSERT(channel.isValid());
+    CPPUNIT_ASSERT_EQUAL(sizeof(iint32), channel.messageSize());
+    const iint64 tooBig = 0;
+    CPPUNIT_ASSERT(!channel.send(&tooBig, sizeof(tooBig)));
+    // The capacity is rounded up to 4
+    for (iint32 i = 0; i < 4; ++i) {
+        CPPUNIT_ASSERT(channel.send(&i, sizeof(i)));
+    }
+    const iint32 dropped = 4;
+    CPPUNIT_ASSERT(!channel.send(&dropped, sizeof(dropped)));
+    CPPUNIT_ASSERT_EQUAL((iuint64) 1, channel.droppedCount());
+    CPPUNIT_ASSERT(!channel.prepareToWait());
+    for (iint32 i = 0; i < 4; ++i) {
+        iint32 message = -1;
+        CPPUNIT_ASSERT(channel.receive(&message));
+        CPPUNIT_ASSERT_EQUAL(i, message);
+    }
+    iint32 message;
+    CPPUNIT_ASSERT(!channel.receive(&message));
+    CPPUNIT_ASSERT(channel.prepareToWait());
+    // Once the receiver waits, the next message wakes it up
+    const iint32 value = 5;
+    CPPUNIT_ASSERT(channel.send(&value, sizeof(value)));
+    CPPUNIT_ASSERT(!channel.prepareToWait());
+    CPPUNIT_ASSERT(channel.receive(&message));
+    CPPUNIT_ASSERT_EQUAL(5, message);
+}
+
+void SharedMemoryChannelTest::testForward()
+{
+    EventLoop eventLoop;
+    SharedMemoryChannel channel(sizeof(std::tuple<iint32>));
+    const pid_t child = fork();
+    CPPUNIT_ASSERT(child != -1);
+    if (!child) {
+        Sender sender;
+        sender.valueChanged.connectShared(channel);
+        for (iint32 i = 1; i <= 1000; ++i) {
+            sender.valueChanged.emit(i);
+            if (!(i % 100)) {
+                usleep(1000);
+            }
+        }
+        _exit(0);
+    }
+    Sender forwarder;
+    Receiver receiver;
+    forwarder.valueChanged.connect(&receiver, &Receiver::add);
+    channel.forward(forwarder.valueChanged, eventLoop);
+    const iuint64 deadline = EventLoop::currentTime() + 5000;
+    while (receiver.m_count < 1000 && EventLoop::currentTime() < deadline) {
+        eventLoop.processEvents();
+    }
+    iint32 status;
+    waitpid(child, &status, 0);
+    CPPUNIT_ASSERT_EQUAL(1000, receiver.m_count);
+    CPPUNIT_ASSERT_EQUAL(500500, receiver.m_sum);
+    CPPUNIT_ASSERT_EQUAL((iuint64) 0, channel.droppedCount());
+}
+
+void SharedMemoryChannelTest::testAttach()
+{
+    iint32 sockets[2];
+    CPPUNIT_ASSERT(!socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    // Forked before the channel exists, so it can only reach it through the socket
+    const pid_t child = fork();
+    CPPUNIT_ASSERT(child != -1);
+    if (!child) {
+        close(sockets[0]);
+        SharedMemoryChannel *const channel = SharedMemoryChannel::attach(sockets[1]);
+        if (!channel || !channel->isValid()) {
+            _exit(1);
+        }
+        Sender sender;
+        sender.valueChanged.connectShared(*channel);
+        for (iint32 i = 1; i <= 1000; ++i) {
+            sender.valueChanged.emit(i);
+            if (!(i % 100)) {
+                usleep(1000);
+            }
+        }
+        _exit(0);
+    }
+    close(sockets[1]);
+    EventLoop eventLoop;
+    SharedMemoryChannel channel(sizeof(std::tuple<iint32>));
+    Sender forwarder;
+    Receiver receiver;
+    forwarder.valueChanged.connect(&receiver, &Receiver::add);
+    channel.forward(forwarder.valueChanged, eventLoop);
+    CPPUNIT_ASSERT(channel.share(sockets[0]));
+    close(sockets[0]);
+    const iuint64 deadline = EventLoop::currentTime() + 5000;
+    while (receiver.m_count < 1000 && EventLoop::currentTime() < deadline) {
+        eventLoop.processEvents();
+    }
+    iint32 status;
+    waitpid(child, &status, 0);
+    CPPUNIT_ASSERT(WIFEXITED(status));
+    CPPUNIT_ASSERT_EQUAL(0, WEXITSTATUS(status));
+    CPPUNIT_ASSERT_EQUAL(1000, receiver.m_count);
+    CPPUNIT_ASSERT_EQUAL(500500, receiver.m_sum);
+    CPPUNIT_ASSERT_EQUAL((iuint64) 0, channel.droppedCount());
+}
+
+#include "test.h"
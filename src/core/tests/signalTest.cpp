@@ -0,0 +1,971 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "signalTest.h"
+
+#include <core/event_loop.h>
+#include <core/ideal_signal.h>
+#include <core/safe_pointer.h>
+#include <core/static_signal.h>
+#include <core/thread_pool.h>
+
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+using namespace IdealCore;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SignalTest);
+
+class Sender
+    : public SignalResource
+{
+public:
+    Sender()
+        : IDEAL_SIGNAL_INIT(valueChanged, iint32)
+        , IDEAL_SIGNAL_INIT(destroyed)
+    {
+    }
+
+    virtual ~Sender()
+    {
+        destroyed.emit();
+    }
+
+    IDEAL_SIGNAL(valueChanged, iint32);
+    IDEAL_SIGNAL(destroyed);
+};
+
+class Receiver
+    : public SignalResource
+{
+public:
+    Receiver()
+        : m_sum(0)
+        , m_ordered(true)
+        , m_batches(0)
+        , m_sender(0)
+    {
+    }
+
+    void add(const iint32 &value)
+    {
+        m_sum += value;
+    }
+
+    void multiplyByTwo(const iint32 &)
+    {
+        m_sum *= 2;
+    }
+
+    void addBatch(const Vector<std::tuple<iint32> > &batch)
+    {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            m_sum += std::get<0>(batch[i]);
+        }
+        ++m_batches;
+    }
+
+    bool addIfPositive(const iint32 &value)
+    {
+        if (value <= 0) {
+            return false;
+        }
+        m_sum += value;
+        return true;
+    }
+
+    bool addIfPositiveFrom(Object *sender, const iint32 &value)
+    {
+        m_sender = sender;
+        return addIfPositive(value);
+    }
+
+    void addInOrder(const iint32 &value)
+    {
+        m_ordered = m_ordered && value == m_sum;
+        m_sum += 1;
+        m_thread = std::this_thread::get_id();
+    }
+
+    iint32          m_sum;
+    bool            m_ordered;
+    iint32          m_batches;
+    Object         *m_sender;
+    std::thread::id m_thread;
+};
+
+class BatchRelay
+    : public Receiver
+{
+public:
+    BatchRelay(Sender &sender)
+        : m_sender(sender)
+    {
+    }
+
+    void relayBatch(const Vector<std::tuple<iint32> > &batch)
+    {
+        const iint32 value = std::get<0>(batch[0]);
+        m_sum += value;
+        if (value > 0) {
+            m_sender.valueChanged.emit(value - 1);
+        }
+        // The nested emissions must not have changed our batch
+        m_sum += std::get<0>(batch[0]);
+    }
+
+    Sender &m_sender;
+};
+
+static iint32 staticSum = 0;
+
+static void addToStaticSum(const iint32 &value)
+{
+    staticSum += value;
+}
+
+static iint32 handledSum = 0;
+
+static bool addToHandledSumIfPositive(const iint32 &value)
+{
+    if (value <= 0) {
+        return false;
+    }
+    handledSum += value;
+    return true;
+}
+
+static bool addToHandledSumIfPositiveFrom(Object *, const iint32 &value)
+{
+    return addToHandledSumIfPositive(value);
+}
+
+class StaticSender
+    : public SignalResource
+{
+public:
+    StaticSender()
+        : IDEAL_SIGNAL_INIT(valueChanged, iint32)
+        , m_sum(0)
+    {
+    }
+
+    void add(const iint32 &value)
+    {
+        m_sum += value;
+    }
+
+    bool handleNegative(const iint32 &value)
+    {
+        return value < 0;
+    }
+
+    void closeOnHundred(const iint32 &value)
+    {
+        if (value == 100) {
+            deleteLater();
+        }
+    }
+
+    typedef StaticSlotList<IDEAL_STATIC_SLOT(&StaticSender::add),
+                           IDEAL_STATIC_SLOT(&addToStaticSum),
+                           IDEAL_STATIC_SLOT(&StaticSender::handleNegative),
+                           IDEAL_STATIC_SLOT(&StaticSender::closeOnHundred)> ValueChangedSlots;
+    IDEAL_STATIC_SIGNAL(valueChanged, ValueChangedSlots, iint32);
+
+    iint32 m_sum;
+};
+
+class QuitEvent
+    : public EventLoop::Event
+{
+public:
+    QuitEvent(EventLoop &eventLoop)
+        : m_eventLoop(eventLoop)
+    {
+    }
+
+    virtual void execute()
+    {
+        m_eventLoop.quit(1);
+    }
+
+    EventLoop &m_eventLoop;
+};
+
+void SignalTest::setUp()
+{
+}
+
+void SignalTest::tearDown()
+{
+}
+
+void SignalTest::testConnectDisconnect()
+{
+    Sender sender;
+    Receiver receiver1;
+    Receiver receiver2;
+    sender.valueChanged.connect(&receiver1, &Receiver::add);
+    sender.valueChanged.connect(&receiver2, &Receiver::add);
+    sender.valueChanged.emit(2);
+    CPPUNIT_ASSERT_EQUAL(2, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(2, receiver2.m_sum);
+    sender.valueChanged.disconnect(&receiver2, &Receiver::add);
+    sender.valueChanged.emit(3);
+    CPPUNIT_ASSERT_EQUAL(5, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(2, receiver2.m_sum);
+    sender.valueChanged.disconnect(&receiver1);
+    sender.valueChanged.emit(3);
+    CPPUNIT_ASSERT_EQUAL(5, receiver1.m_sum);
+}
+
+class UnblockableSender
+    : public Sender
+{
+public:
+    virtual void setEmitBlocked(bool emitBlocked)
+    {
+        IDEAL_UNUSED(emitBlocked);
+        Sender::setEmitBlocked(false);
+    }
+};
+
+void SignalTest::testBlocked()
+{
+    Sender sender;
+    Receiver receiver;
+    sender.valueChanged.connect(&receiver, &Receiver::add);
+    receiver.setSignalsBlocked(true);
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(0, receiver.m_sum);
+    receiver.setSignalsBlocked(false);
+    sender.setEmitBlocked(true);
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(0, receiver.m_sum);
+    sender.setEmitBlocked(false);
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(1, receiver.m_sum);
+    // setEmitBlocked() can be reimplemented
+    UnblockableSender unblockable;
+    unblockable.valueChanged.connect(&receiver, &Receiver::add);
+    static_cast<SignalResource&>(unblockable).setEmitBlocked(true);
+    CPPUNIT_ASSERT(!unblockable.isEmitBlocked());
+    unblockable.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(2, receiver.m_sum);
+}
+
+void SignalTest::testConnection()
+{
+    {
+        Sender sender;
+        Receiver receiver1;
+        Receiver receiver2;
+        Connection connection1 = sender.valueChanged.connect(&receiver1, &Receiver::add);
+        Connection connection2 = sender.valueChanged.connect(&receiver2, &Receiver::add);
+        CPPUNIT_ASSERT(connection1.isConnected());
+        CPPUNIT_ASSERT(connection1 != connection2);
+        connection1.disconnect();
+        CPPUNIT_ASSERT(!connection1.isConnected());
+        sender.valueChanged.emit(1);
+        CPPUNIT_ASSERT_EQUAL(0, receiver1.m_sum);
+        CPPUNIT_ASSERT_EQUAL(1, receiver2.m_sum);
+        // Disconnecting twice, or through the compatibility path afterwards, does nothing
+        connection1.disconnect();
+        sender.valueChanged.disconnect(&receiver1, &Receiver::add);
+        sender.valueChanged.emit(1);
+        CPPUNIT_ASSERT_EQUAL(2, receiver2.m_sum);
+        {
+            ScopedConnection scopedConnection(sender.valueChanged.connect(&receiver1, &Receiver::add));
+            sender.valueChanged.emit(1);
+            CPPUNIT_ASSERT_EQUAL(1, receiver1.m_sum);
+        }
+        sender.valueChanged.emit(1);
+        CPPUNIT_ASSERT_EQUAL(1, receiver1.m_sum);
+        CPPUNIT_ASSERT_EQUAL(4, receiver2.m_sum);
+    }
+    // Connections are reported as disconnected once their signal is destroyed
+    {
+        Connection connection;
+        Receiver receiver;
+        {
+            Sender sender;
+            connection = sender.valueChanged.connect(&receiver, &Receiver::add);
+            CPPUNIT_ASSERT(connection.isConnected());
+        }
+        CPPUNIT_ASSERT(!connection.isConnected());
+        connection.disconnect();
+    }
+    // Many disconnections in any order
+    {
+        Sender sender;
+        Receiver receivers[100];
+        Connection connections[100];
+        for (iint32 i = 0; i < 100; ++i) {
+            connections[i] = sender.valueChanged.connect(&receivers[i], &Receiver::add);
+        }
+        for (iint32 i = 0; i < 100; i += 3) {
+            connections[i].disconnect();
+        }
+        sender.valueChanged.emit(1);
+        for (iint32 i = 0; i < 100; ++i) {
+            CPPUNIT_ASSERT_EQUAL(i % 3 ? 1 : 0, receivers[i].m_sum);
+            connections[i].disconnect();
+        }
+        sender.valueChanged.emit(1);
+        for (iint32 i = 0; i < 100; ++i) {
+            CPPUNIT_ASSERT_EQUAL(i % 3 ? 1 : 0, receivers[i].m_sum);
+        }
+    }
+    // SafePointer
+    {
+        Sender *sender = new Sender;
+        SafePointer<Sender> safePointer1(sender);
+        {
+            SafePointer<Sender> safePointer2(sender);
+        }
+        safePointer1 = sender;
+        SafePointer<Sender> safePointers[1000];
+        for (iint32 i = 0; i < 1000; ++i) {
+            safePointers[i] = i % 2 ? safePointer1 : SafePointer<Sender>(sender);
+        }
+        CPPUNIT_ASSERT(safePointers[999] == sender);
+        delete sender;
+        CPPUNIT_ASSERT(safePointer1.isContentDestroyed());
+        for (iint32 i = 0; i < 1000; ++i) {
+            CPPUNIT_ASSERT(!safePointers[i]);
+        }
+        SafePointer<Sender> safePointer3(safePointers[0]);
+        CPPUNIT_ASSERT(!safePointer3.content());
+    }
+}
+
+void SignalTest::testConcurrentConnections()
+{
+    Sender sender;
+    std::atomic<iint32> temporaryCalls(0);
+    std::atomic<iint32> calls(0);
+    std::thread threads[3];
+    for (iint32 i = 0; i < 3; ++i) {
+        threads[i] = std::thread([&sender, &temporaryCalls, &calls] {
+            for (iint32 j = 0; j < 2000; ++j) {
+                Connection connection = sender.valueChanged.connect([&temporaryCalls](iint32) { temporaryCalls.fetch_add(1); });
+                sender.valueChanged.connect([&calls](iint32) { calls.fetch_add(1); });
+                sender.valueChanged.emit(1);
+                connection.disconnect();
+            }
+        });
+    }
+    for (iint32 i = 0; i < 3; ++i) {
+        threads[i].join();
+    }
+    // Each emission reaches at least the temporary connection of its own thread
+    CPPUNIT_ASSERT(temporaryCalls.load() >= 6000);
+    temporaryCalls.store(0);
+    calls.store(0);
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(0, temporaryCalls.load());
+    CPPUNIT_ASSERT_EQUAL(6000, calls.load());
+}
+
+void SignalTest::testUnconnected()
+{
+    // Only the parent, the name, the destroyed flag and the connections pointer
+#ifdef IDEAL_SIGNAL_METRICS
+    CPPUNIT_ASSERT(sizeof(Signal<iint32>) <= 6 * sizeof(void*));
+#else
+    CPPUNIT_ASSERT(sizeof(Signal<iint32>) <= 5 * sizeof(void*));
+#endif
+    Sender sender;
+    sender.valueChanged.emit(1);
+    // The thread pool is kept when all connections are removed
+    ThreadPool threadPool(4);
+    sender.valueChanged.setThreadPool(&threadPool);
+    Receiver receivers[10];
+    for (iint32 i = 0; i < 10; ++i) {
+        sender.valueChanged.connect(&receivers[i], &Receiver::add);
+    }
+    sender.valueChanged.SignalBase::disconnect();
+    sender.valueChanged.emitParallel(1);
+    for (iint32 i = 0; i < 10; ++i) {
+        CPPUNIT_ASSERT_EQUAL(0, receivers[i].m_sum);
+        sender.valueChanged.connect(&receivers[i], &Receiver::add);
+    }
+    sender.valueChanged.emitParallel(1);
+    for (iint32 i = 0; i < 10; ++i) {
+        CPPUNIT_ASSERT_EQUAL(1, receivers[i].m_sum);
+    }
+    sender.valueChanged.setThreadPool(0);
+    sender.valueChanged.emit(1);
+    for (iint32 i = 0; i < 10; ++i) {
+        CPPUNIT_ASSERT_EQUAL(2, receivers[i].m_sum);
+    }
+}
+
+void SignalTest::testDeleteLater()
+{
+    // Deleted once the emission is done, so all slots are called
+    {
+        Sender *sender = new Sender;
+        SafePointer<Sender> safePointer(sender);
+        Receiver receiver;
+        sender->valueChanged.connect([sender](iint32) { sender->deleteLater(); });
+        sender->valueChanged.connect(&receiver, &Receiver::add);
+        sender->valueChanged.emit(1);
+        CPPUNIT_ASSERT_EQUAL(1, receiver.m_sum);
+        CPPUNIT_ASSERT(safePointer.isContentDestroyed());
+    }
+    // Deleted once the event loop iteration is done
+    {
+        Sender *sender = new Sender;
+        SafePointer<Sender> safePointer(sender);
+        bool alive = false;
+        EventLoop eventLoop;
+        eventLoop.postCallback([sender] { sender->deleteLater(); });
+        eventLoop.postCallback([&safePointer, &alive] { alive = safePointer; });
+        eventLoop.processEvents();
+        CPPUNIT_ASSERT(alive);
+        CPPUNIT_ASSERT(safePointer.isContentDestroyed());
+    }
+    // Deleted right away otherwise
+    {
+        Sender *sender = new Sender;
+        SafePointer<Sender> safePointer(sender);
+        sender->deleteLater();
+        CPPUNIT_ASSERT(safePointer.isContentDestroyed());
+    }
+}
+
+void SignalTest::testQueued()
+{
+    {
+        Sender sender;
+        Receiver receiver;
+        EventLoop eventLoop;
+        iint32 returnCode = 0;
+        std::thread thread([&eventLoop, &returnCode] { returnCode = eventLoop.exec(); });
+        const std::thread::id threadId = thread.get_id();
+        sender.valueChanged.connectQueued(&receiver, &Receiver::addInOrder, eventLoop);
+        for (iint32 i = 0; i < 10000; ++i) {
+            sender.valueChanged.emit(i);
+        }
+        eventLoop.post(new QuitEvent(eventLoop));
+        thread.join();
+        CPPUNIT_ASSERT_EQUAL(1, returnCode);
+        CPPUNIT_ASSERT_EQUAL(10000, receiver.m_sum);
+        CPPUNIT_ASSERT(receiver.m_ordered);
+        CPPUNIT_ASSERT(receiver.m_thread == threadId);
+    }
+    // Emissions pending when the connection goes away are not delivered
+    {
+        Sender sender;
+        Receiver receiver;
+        EventLoop eventLoop;
+        Connection connection = sender.valueChanged.connectQueued(&receiver, &Receiver::add, eventLoop);
+        sender.valueChanged.emit(1);
+        sender.valueChanged.emit(2);
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, eventLoop.processEvents());
+        CPPUNIT_ASSERT_EQUAL(3, receiver.m_sum);
+        sender.valueChanged.emit(4);
+        connection.disconnect();
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, eventLoop.processEvents());
+        CPPUNIT_ASSERT_EQUAL(3, receiver.m_sum);
+    }
+}
+
+void SignalTest::testDeliveryPolicy()
+{
+    // Emissions not delivered yet are replaced by the newest one
+    {
+        Sender sender;
+        Receiver receiver;
+        EventLoop eventLoop;
+        sender.valueChanged.connectQueued(&receiver, &Receiver::add, eventLoop, DeliveryPolicy::coalesced());
+        sender.valueChanged.emit(1);
+        sender.valueChanged.emit(2);
+        sender.valueChanged.emit(3);
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, eventLoop.processEvents());
+        CPPUNIT_ASSERT_EQUAL(3, receiver.m_sum);
+        sender.valueChanged.emit(4);
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, eventLoop.processEvents());
+        CPPUNIT_ASSERT_EQUAL(7, receiver.m_sum);
+    }
+    // Emitting every 5 milliseconds for 200 milliseconds, delivered at most every 50 milliseconds
+    {
+        Sender sender;
+        Receiver receiver;
+        EventLoop eventLoop;
+        sender.valueChanged.connectQueued(&receiver, &Receiver::add, eventLoop, DeliveryPolicy::throttled(50));
+        eventLoop.timeout.connect([&sender](iuint64) { sender.valueChanged.emit(1); });
+        eventLoop.startTimer(5);
+        eventLoop.postDelayed(new QuitEvent(eventLoop), 200);
+        eventLoop.exec();
+        CPPUNIT_ASSERT(receiver.m_sum >= 2);
+        CPPUNIT_ASSERT(receiver.m_sum <= 5);
+    }
+    // Emitting every 5 milliseconds for 100 milliseconds, delivered once when emissions stop
+    {
+        Sender sender;
+        Receiver receiver;
+        EventLoop eventLoop;
+        sender.valueChanged.connectQueued(&receiver, &Receiver::add, eventLoop, DeliveryPolicy::debounced(50));
+        iuint64 timer = 0;
+        iint32 emitted = 0;
+        eventLoop.timeout.connect([&](iuint64) {
+            sender.valueChanged.emit(++emitted);
+            if (emitted == 20) {
+                eventLoop.stopTimer(timer);
+            }
+        });
+        timer = eventLoop.startTimer(5);
+        eventLoop.postDelayed(new QuitEvent(eventLoop), 300);
+        eventLoop.exec();
+        CPPUNIT_ASSERT_EQUAL(20, receiver.m_sum);
+    }
+}
+
+void SignalTest::testParallel()
+{
+    ThreadPool threadPool(4);
+    Sender sender;
+    sender.valueChanged.setThreadPool(&threadPool);
+    Receiver receivers[100];
+    for (iint32 i = 0; i < 100; ++i) {
+        sender.valueChanged.connect(&receivers[i], &Receiver::add);
+    }
+    sender.valueChanged.emitParallel(2);
+    for (iint32 i = 0; i < 100; ++i) {
+        CPPUNIT_ASSERT_EQUAL(2, receivers[i].m_sum);
+    }
+    // Slots of the same receiver are called in the order they were connected
+    for (iint32 i = 0; i < 100; ++i) {
+        sender.valueChanged.connect(&receivers[i], &Receiver::multiplyByTwo);
+        receivers[i].m_sum = 0;
+    }
+    for (iint32 i = 0; i < 10; ++i) {
+        sender.valueChanged.emitParallelOrdered(1);
+    }
+    for (iint32 i = 0; i < 100; ++i) {
+        CPPUNIT_ASSERT_EQUAL(2046, receivers[i].m_sum);
+    }
+}
+
+void SignalTest::testFunctor()
+{
+    Sender sender;
+    Sender forwarder;
+    iint32 sum = 0;
+    iint32 calls = 0;
+    Connection connection = sender.valueChanged.connect([&sum](const iint32 &value) { sum += value; });
+    sender.valueChanged.connect([&calls](iint32) mutable { ++calls; });
+    // Signals are still connected as forwards, not as functors
+    sender.valueChanged.connect(forwarder.valueChanged);
+    forwarder.valueChanged.connect([&sum](const iint32 &value) { sum += 10 * value; });
+    sender.valueChanged.emit(2);
+    CPPUNIT_ASSERT_EQUAL(22, sum);
+    CPPUNIT_ASSERT_EQUAL(1, calls);
+    connection.disconnect();
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(32, sum);
+    CPPUNIT_ASSERT_EQUAL(2, calls);
+}
+
+void SignalTest::testForwardChain()
+{
+    Sender sender;
+    Sender relays[3];
+    Receiver receiver1;
+    Receiver receiver2;
+    sender.valueChanged.connect(relays[0].valueChanged);
+    relays[0].valueChanged.connect(relays[1].valueChanged);
+    relays[1].valueChanged.connect(relays[2].valueChanged);
+    relays[2].valueChanged.connect(&receiver1, &Receiver::add);
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(1, receiver1.m_sum);
+    // Changing any link is seen by the next emission
+    relays[1].valueChanged.connect(&receiver2, &Receiver::add);
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(2, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(1, receiver2.m_sum);
+    relays[1].setEmitBlocked(true);
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(2, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(1, receiver2.m_sum);
+    relays[1].setEmitBlocked(false);
+    relays[1].valueChanged.disconnect(relays[2].valueChanged);
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(2, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(2, receiver2.m_sum);
+    relays[0].valueChanged.SignalBase::disconnect();
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(2, receiver2.m_sum);
+    // Emitting a link directly still works
+    relays[1].valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(3, receiver2.m_sum);
+    // Each chain is only rebuilt when one of its own links changes
+    Sender other;
+    relays[2].valueChanged.connect(other.valueChanged);
+    other.valueChanged.connect(&receiver2, &Receiver::add);
+    relays[1].valueChanged.connect(relays[2].valueChanged);
+    relays[1].valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(3, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(5, receiver2.m_sum);
+    other.setEmitBlocked(true);
+    relays[1].valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(4, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(6, receiver2.m_sum);
+    other.setEmitBlocked(false);
+    relays[1].valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(5, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(8, receiver2.m_sum);
+    // Lists forwarding to each other reference each other's lists while blocked
+    relays[0].valueChanged.connect(relays[1].valueChanged);
+    relays[1].valueChanged.connect(relays[0].valueChanged);
+    relays[0].setEmitBlocked(true);
+    relays[1].valueChanged.emit(1);
+    relays[0].setEmitBlocked(false);
+    relays[1].setEmitBlocked(true);
+    relays[0].valueChanged.emit(1);
+    relays[1].setEmitBlocked(false);
+    CPPUNIT_ASSERT_EQUAL(6, receiver1.m_sum);
+    // A slot destroying a signal of the chain only stops the slots of that signal
+    Sender source;
+    Sender *relay = new Sender;
+    Receiver receiver3;
+    source.valueChanged.connect(relay->valueChanged);
+    relay->valueChanged.connect([&relay](iint32) { delete relay; relay = 0; });
+    relay->valueChanged.connect(&receiver3, &Receiver::add);
+    source.valueChanged.connect(&receiver3, &Receiver::add);
+    source.valueChanged.emit(5);
+    CPPUNIT_ASSERT(!relay);
+    CPPUNIT_ASSERT_EQUAL(5, receiver3.m_sum);
+}
+
+void SignalTest::testPriority()
+{
+    Sender sender;
+    iint32 order = 0;
+    Connection first = sender.valueChanged.connect([&order](iint32) { order = order * 10 + 1; });
+    Connection second = sender.valueChanged.connect([&order](iint32) { order = order * 10 + 2; });
+    Connection third = sender.valueChanged.connect([&order](iint32) { order = order * 10 + 3; });
+    sender.valueChanged.emit(0);
+    CPPUNIT_ASSERT_EQUAL(123, order);
+    // Higher priority first, connection order for the same priority
+    third.setPriority(1);
+    first.setPriority(-1);
+    CPPUNIT_ASSERT_EQUAL(1, third.priority());
+    order = 0;
+    sender.valueChanged.emit(0);
+    CPPUNIT_ASSERT_EQUAL(321, order);
+    sender.valueChanged.connect([&order](iint32) { order = order * 10 + 4; });
+    order = 0;
+    sender.valueChanged.emit(0);
+    CPPUNIT_ASSERT_EQUAL(3241, order);
+    // The first slot returning true stops the emission
+    Receiver receiver;
+    Connection handler = sender.valueChanged.connect(&receiver, &Receiver::addIfPositive);
+    handler.setPriority(2);
+    order = 0;
+    CPPUNIT_ASSERT(sender.valueChanged.emitUntilHandled(5));
+    CPPUNIT_ASSERT_EQUAL(5, receiver.m_sum);
+    CPPUNIT_ASSERT_EQUAL(0, order);
+    CPPUNIT_ASSERT(!sender.valueChanged.emitUntilHandled(-5));
+    CPPUNIT_ASSERT_EQUAL(5, receiver.m_sum);
+    CPPUNIT_ASSERT_EQUAL(3241, order);
+    // Functors and forwards can handle it as well
+    Sender forwarder;
+    forwarder.valueChanged.connect([](const iint32 &value) { return value == -1; });
+    Connection forward = sender.valueChanged.connect(forwarder.valueChanged);
+    forward.setPriority(3);
+    order = 0;
+    CPPUNIT_ASSERT(sender.valueChanged.emitUntilHandled(-1));
+    CPPUNIT_ASSERT_EQUAL(0, order);
+    // emit() calls all of them
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(6, receiver.m_sum);
+    CPPUNIT_ASSERT_EQUAL(3241, order);
+    // Every kind of slot tells whether it handled the emission
+    Mutex mutex;
+    Sender other;
+    const iint32 multiSum = receiver.m_sum;
+    Connection multi = other.valueChanged.connectMulti(&receiver, &Receiver::addIfPositiveFrom);
+    CPPUNIT_ASSERT(other.valueChanged.emitUntilHandled(1));
+    CPPUNIT_ASSERT(!other.valueChanged.emitUntilHandled(-1));
+    CPPUNIT_ASSERT_EQUAL(multiSum + 1, receiver.m_sum);
+    CPPUNIT_ASSERT(receiver.m_sender == reinterpret_cast<Object*>(&other));
+    multi.disconnect();
+    other.valueChanged.connectMultiSynchronized(&receiver, &Receiver::addIfPositiveFrom, mutex);
+    CPPUNIT_ASSERT(other.valueChanged.emitUntilHandled(1));
+    CPPUNIT_ASSERT_EQUAL(multiSum + 2, receiver.m_sum);
+    Sender staticSender;
+    Connection staticHandler = staticSender.valueChanged.connectStaticSynchronized(&addToHandledSumIfPositive, mutex);
+    CPPUNIT_ASSERT(staticSender.valueChanged.emitUntilHandled(1));
+    CPPUNIT_ASSERT(!staticSender.valueChanged.emitUntilHandled(-1));
+    staticHandler.disconnect();
+    staticHandler = staticSender.valueChanged.connectStaticMulti(&addToHandledSumIfPositiveFrom);
+    CPPUNIT_ASSERT(staticSender.valueChanged.emitUntilHandled(1));
+    staticHandler.disconnect();
+    staticSender.valueChanged.connectStaticMultiSynchronized(&addToHandledSumIfPositiveFrom, mutex);
+    CPPUNIT_ASSERT(staticSender.valueChanged.emitUntilHandled(1));
+    CPPUNIT_ASSERT(!staticSender.valueChanged.emitUntilHandled(-1));
+    CPPUNIT_ASSERT_EQUAL(3, handledSum);
+}
+
+void SignalTest::testBatch()
+{
+    Sender sender;
+    Sender forwarder;
+    Receiver receiver1;
+    Receiver receiver2;
+    Receiver receiver3;
+    sender.valueChanged.connect(&receiver1, &Receiver::add);
+    sender.valueChanged.connectBatch(&receiver2, &Receiver::addBatch);
+    sender.valueChanged.connect(forwarder.valueChanged);
+    forwarder.valueChanged.connectBatch(&receiver3, &Receiver::addBatch);
+    Vector<std::tuple<iint32> > batch;
+    for (iint32 i = 1; i <= 100; ++i) {
+        batch.append(std::make_tuple(i));
+    }
+    sender.valueChanged.emitBatch(batch);
+    CPPUNIT_ASSERT_EQUAL(5050, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(5050, receiver2.m_sum);
+    CPPUNIT_ASSERT_EQUAL(1, receiver2.m_batches);
+    // Forwards keep the batch
+    CPPUNIT_ASSERT_EQUAL(5050, receiver3.m_sum);
+    CPPUNIT_ASSERT_EQUAL(1, receiver3.m_batches);
+    sender.valueChanged.emit(10);
+    CPPUNIT_ASSERT_EQUAL(5060, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(5060, receiver2.m_sum);
+    CPPUNIT_ASSERT_EQUAL(2, receiver2.m_batches);
+    // Each emit() reaches batch slots with a batch holding its own value, also when nested
+    Sender relaySender;
+    BatchRelay relay(relaySender);
+    relaySender.valueChanged.connectBatch(&relay, &BatchRelay::relayBatch);
+    relaySender.valueChanged.emit(3);
+    CPPUNIT_ASSERT_EQUAL(12, relay.m_sum);
+    relaySender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(14, relay.m_sum);
+    receiver2.setSignalsBlocked(true);
+    sender.valueChanged.emitBatch(batch);
+    CPPUNIT_ASSERT_EQUAL(10110, receiver1.m_sum);
+    CPPUNIT_ASSERT_EQUAL(2, receiver2.m_batches);
+}
+
+void SignalTest::testStaticSignal()
+{
+    StaticSender sender;
+    Receiver receiver;
+    sender.valueChanged.emit(2);
+    CPPUNIT_ASSERT_EQUAL(2, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(2, staticSum);
+    // Slots connected at runtime are called after the static ones
+    sender.valueChanged.connect(&receiver, &Receiver::add);
+    sender.valueChanged.emit(3);
+    CPPUNIT_ASSERT_EQUAL(5, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(5, staticSum);
+    CPPUNIT_ASSERT_EQUAL(3, receiver.m_sum);
+    Vector<std::tuple<iint32> > batch;
+    batch.append(std::make_tuple(1));
+    batch.append(std::make_tuple(2));
+    sender.valueChanged.emitBatch(batch);
+    CPPUNIT_ASSERT_EQUAL(8, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(8, staticSum);
+    CPPUNIT_ASSERT_EQUAL(6, receiver.m_sum);
+    sender.setEmitBlocked(true);
+    sender.valueChanged.emit(3);
+    CPPUNIT_ASSERT_EQUAL(8, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(6, receiver.m_sum);
+    sender.setEmitBlocked(false);
+    // Every way of emitting calls the static slots
+    const Signal<iint32> &signal = sender.valueChanged;
+    signal.emit(1);
+    CPPUNIT_ASSERT_EQUAL(9, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(7, receiver.m_sum);
+    Sender forwarder;
+    forwarder.valueChanged.connect(sender.valueChanged);
+    forwarder.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(10, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(8, receiver.m_sum);
+    forwarder.valueChanged.emitBatch(batch);
+    CPPUNIT_ASSERT_EQUAL(13, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(11, receiver.m_sum);
+    sender.valueChanged.emitParallel(1);
+    CPPUNIT_ASSERT_EQUAL(14, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(12, receiver.m_sum);
+    // Static slots can handle the emission before the connected ones are called
+    CPPUNIT_ASSERT(!signal.emitUntilHandled(1));
+    CPPUNIT_ASSERT_EQUAL(15, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(13, receiver.m_sum);
+    CPPUNIT_ASSERT(signal.emitUntilHandled(-1));
+    CPPUNIT_ASSERT(forwarder.valueChanged.emitUntilHandled(-1));
+    CPPUNIT_ASSERT_EQUAL(13, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(13, receiver.m_sum);
+    // They are kept when all connections are removed, and are not called while signals are blocked
+    sender.valueChanged.SignalBase::disconnect();
+    sender.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(14, sender.m_sum);
+    CPPUNIT_ASSERT_EQUAL(13, receiver.m_sum);
+    sender.setSignalsBlocked(true);
+    forwarder.valueChanged.emit(1);
+    CPPUNIT_ASSERT_EQUAL(14, sender.m_sum);
+    sender.setSignalsBlocked(false);
+    // A static slot can delete its owner with deleteLater(), which waits for the emission
+    StaticSender *owner = new StaticSender;
+    SafePointer<StaticSender> safePointer(owner);
+    owner->valueChanged.connect(&receiver, &Receiver::add);
+    Sender emitter;
+    emitter.valueChanged.connect(owner->valueChanged);
+    emitter.valueChanged.emit(100);
+    CPPUNIT_ASSERT_EQUAL(113, receiver.m_sum);
+    CPPUNIT_ASSERT(safePointer.isContentDestroyed());
+}
+
+void SignalTest::testMetrics()
+{
+#ifdef IDEAL_SIGNAL_METRICS
+    Sender sender;
+    Receiver receiver1;
+    Receiver receiver2;
+    sender.valueChanged.connect(&receiver1, &Receiver::add);
+    Connection connection = sender.valueChanged.connect(&receiver2, &Receiver::add);
+    sender.valueChanged.emit(1);
+    sender.valueChanged.emit(2);
+    connection.disconnect();
+    sender.valueChanged.emit(3);
+    sender.setEmitBlocked(true);
+    sender.valueChanged.emit(4);
+    const SignalMetrics::Record *const record = sender.valueChanged.metrics();
+    CPPUNIT_ASSERT(!strcmp(record->name(), "valueChanged"));
+    CPPUNIT_ASSERT(!strcmp(record->signature(), "iint32"));
+    CPPUNIT_ASSERT(record->parent() == &sender);
+    CPPUNIT_ASSERT_EQUAL((iuint64) 3, record->latency().count());
+    const SignalMetrics::Slot *const slot1 = record->firstSlot();
+    CPPUNIT_ASSERT(slot1->receiver() == &receiver1);
+    CPPUNIT_ASSERT_EQUAL((iuint64) 3, slot1->latency().count());
+    const SignalMetrics::Slot *const slot2 = slot1->next();
+    CPPUNIT_ASSERT(slot2->receiver() == &receiver2);
+    CPPUNIT_ASSERT_EQUAL((iuint64) 2, slot2->latency().count());
+    CPPUNIT_ASSERT(!slot2->next());
+    CPPUNIT_ASSERT(record->latency().percentile(50) <= record->latency().percentile(100));
+    std::ostringstream json;
+    SignalMetrics::dump(json, SignalMetrics::Json);
+    CPPUNIT_ASSERT(json.str().find("\"name\":\"valueChanged\",\"signature\":\"iint32\"") != std::string::npos);
+    SignalMetrics::reset();
+    CPPUNIT_ASSERT_EQUAL((iuint64) 0, record->latency().count());
+    CPPUNIT_ASSERT_EQUAL((iuint64) 0, slot1->latency().count());
+    // Once its callback is destroyed, the calls of a connection are kept aside
+    sender.setEmitBlocked(false);
+    connection = Connection();
+    Connection connection3 = sender.valueChanged.connect(&receiver2, &Receiver::add);
+    Epoch::synchronize();
+    const SignalMetrics::Slot *const slot3 = slot1->next();
+    CPPUNIT_ASSERT(slot3->receiver() == &receiver2);
+    CPPUNIT_ASSERT(!slot3->next());
+    sender.valueChanged.emit(5);
+    CPPUNIT_ASSERT_EQUAL((iuint64) 0, record->disconnectedLatency().count());
+    connection3.disconnect();
+    connection3 = Connection();
+    sender.valueChanged.connect(&receiver2, &Receiver::add);
+    Epoch::synchronize();
+    CPPUNIT_ASSERT_EQUAL((iuint64) 1, slot1->latency().count());
+    CPPUNIT_ASSERT_EQUAL((iuint64) 0, slot1->next()->latency().count());
+    CPPUNIT_ASSERT_EQUAL((iuint64) 1, record->disconnectedLatency().count());
+    // A batch counts as one emission per element, and each slot call is recorded
+    const iuint64 emitCount = record->latency().count();
+    Vector<std::tuple<iint32> > batch;
+    batch.append(std::make_tuple(1));
+    batch.append(std::make_tuple(2));
+    batch.append(std::make_tuple(3));
+    sender.valueChanged.emitBatch(batch);
+    CPPUNIT_ASSERT_EQUAL(emitCount + 3, record->latency().count());
+    CPPUNIT_ASSERT_EQUAL((iuint64) 4, slot1->latency().count());
+    // Signals reached through a forward record their own emissions
+    Sender forwarder;
+    Receiver receiver3;
+    sender.valueChanged.connect(forwarder.valueChanged);
+    Connection forwarded = forwarder.valueChanged.connect(&receiver3, &Receiver::add);
+    sender.valueChanged.emit(8);
+    CPPUNIT_ASSERT_EQUAL(8, receiver3.m_sum);
+    CPPUNIT_ASSERT_EQUAL((iuint64) 1, forwarder.valueChanged.metrics()->latency().count());
+    CPPUNIT_ASSERT_EQUAL((iuint64) 1, forwarder.valueChanged.metrics()->firstSlot()->latency().count());
+    // A slot can destroy the signal it is connected to while a forward is calling it
+    Sender *relay = new Sender;
+    sender.valueChanged.connect(relay->valueChanged);
+    relay->valueChanged.connect([&relay](iint32) { delete relay; relay = 0; });
+    sender.valueChanged.emit(7);
+    CPPUNIT_ASSERT(!relay);
+#endif
+}
+
+void SignalTest::testTrace()
+{
+    Sender sender;
+    Receiver receiver;
+    EventLoop eventLoop;
+    sender.valueChanged.connect(&receiver, &Receiver::add);
+    sender.valueChanged.connectQueued(&receiver, &Receiver::add, eventLoop);
+    SignalTrace::clear();
+    sender.valueChanged.emit(1);
+    eventLoop.processEvents();
+    SignalTrace::setEnabled(true);
+    sender.valueChanged.emit(2);
+    eventLoop.processEvents();
+    SignalTrace::setEnabled(false);
+    sender.valueChanged.emit(3);
+    eventLoop.processEvents();
+    CPPUNIT_ASSERT_EQUAL(12, receiver.m_sum);
+    std::ostringstream trace;
+    SignalTrace::exportChromeTrace(trace);
+    const std::string json = trace.str();
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, json.find("{\"traceEvents\":["));
+    CPPUNIT_ASSERT(json.find("{\"name\":\"valueChanged\",\"cat\":\"emission\",\"ph\":\"X\"") != std::string::npos);
+    CPPUNIT_ASSERT(json.find("{\"name\":\"valueChanged\",\"cat\":\"queued call\",\"ph\":\"X\"") != std::string::npos);
+    // The emission, its two calls (the direct one and posting to the event loop) and the queued call
+    size_t eventCount = 0;
+    for (size_t i = json.find("\"ph\":\"X\""); i != std::string::npos; i = json.find("\"ph\":\"X\"", i + 1)) {
+        ++eventCount;
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, eventCount);
+    SignalTrace::clear();
+    std::ostringstream empty;
+    SignalTrace::exportChromeTrace(empty);
+    CPPUNIT_ASSERT(empty.str().find("valueChanged") == std::string::npos);
+    // Signals reached through a forward trace their own emissions
+    Sender forwarder;
+    sender.valueChanged.connect(forwarder.valueChanged);
+    forwarder.valueChanged.connect(&receiver, &Receiver::add);
+    SignalTrace::setEnabled(true);
+    sender.valueChanged.emit(4);
+    SignalTrace::setEnabled(false);
+    eventLoop.processEvents();
+    std::ostringstream forwardTrace;
+    SignalTrace::exportChromeTrace(forwardTrace);
+    const std::string forwardJson = forwardTrace.str();
+    size_t emissionCount = 0;
+    for (size_t i = forwardJson.find("\"cat\":\"emission\""); i != std::string::npos;
+         i = forwardJson.find("\"cat\":\"emission\"", i + 1)) {
+        ++emissionCount;
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, emissionCount);
+    SignalTrace::clear();
+}
+
+#include "test.h"
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class SignalTest
+    : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(SignalTest);
+    CPPUNIT_TEST(testConnectDisconnect);
+    CPPUNIT_TEST(testBlocked);
+    CPPUNIT_TEST(testConnection);
+    CPPUNIT_TEST(testConcurrentConnections);
+    CPPUNIT_TEST(testUnconnected);
+    CPPUNIT_TEST(testDeleteLater);
+    CPPUNIT_TEST(testQueued);
+    CPPUNIT_TEST(testDeliveryPolicy);
+    CPPUNIT_TEST(testParallel);
+    CPPUNIT_TEST(testFunctor);
+    CPPUNIT_TEST(testForwardChain);
+    CPPUNIT_TEST(testPriority);
+    CPPUNIT_TEST(testBatch);
+    CPPUNIT_TEST(testStaticSignal);
+    CPPUNIT_TEST(testMetrics);
+    CPPUNIT_TEST(testTrace);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testConnectDisconnect();
+    void testBlocked();
+    void testConnection();
+    void testConcurrentConnections();
+    void testUnconnected();
+    void testDeleteLater();
+    void testQueued();
+    void testDeliveryPolicy();
+    void testParallel();
+    void testFunctor();
+    void testForwardChain();
+    void testPriority();
+    void testBatch();
+    void testStaticSignal();
+    void testMetrics();
+    void testTrace();
+};
@@ -0,0 +1,51 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <core/uri.h>
+#include <core/uri_batch.h>
+#include <core/uri_scanner.h>
+
+class UriTest
+    : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(UriTest);
+    CPPUNIT_TEST(testComponents);
+    CPPUNIT_TEST(testHostAddress);
+    CPPUNIT_TEST(testHostAddressToString);
+    CPPUNIT_TEST(testAsciiHost);
+    CPPUNIT_TEST(testBatch);
+    CPPUNIT_TEST(testScanner);
+    CPPUNIT_TEST(testConcurrentAccess);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testComponents();
+    void testHostAddress();
+    void testHostAddressToString();
+    void testAsciiHost();
+    void testBatch();
+    void testScanner();
+    void testConcurrentAccess();
+};
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "thread_pool.h"
+#include "context_mutex_locker.h"
+#include "private/thread_pool_p.h"
+
+namespace IdealCore {
+
+ThreadPool::Private::Private(size_t threadCount)
+    : m_threadCount(threadCount)
+    , m_condition(m_mutex)
+    , m_head(0)
+    , m_tail(0)
+    , m_stop(false)
+{
+}
+
+ThreadPool::Private::~Private()
+{
+}
+
+void ThreadPool::Private::work()
+{
+    m_mutex.lock();
+    while (true) {
+        while (!m_head && !m_stop) {
+            m_condition.wait();
+        }
+        Task *const task = m_head;
+        if (!task) {
+            break;
+        }
+        m_head = task->m_next;
+        if (!m_head) {
+            m_tail = 0;
+        }
+        m_mutex.unlock();
+        task->run();
+        delete task;
+        m_mutex.lock();
+    }
+    m_mutex.unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::Task::Task()
+    : m_next(0)
+{
+}
+
+ThreadPool::Task::~Task()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : d(new PrivateImpl(threadCount ? threadCount : PrivateImpl::hardwareThreadCount()))
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        ContextMutexLocker cml(d->m_mutex);
+        d->m_stop = true;
+        d->m_condition.broadcast();
+    }
+    D_I->join();
+    delete d;
+}
+
+void ThreadPool::start(Task *task)
+{
+    task->m_next = 0;
+    ContextMutexLocker cml(d->m_mutex);
+    if (d->m_tail) {
+        d->m_tail->m_next = task;
+    } else {
+        d->m_head = task;
+    }
+    d->m_tail = task;
+    d->m_condition.signal();
+}
+
+size_t ThreadPool::threadCount() const
+{
+    return d->m_threadCount;
+}
+
+ThreadPool *ThreadPool::globalInstance()
+{
+    static ThreadPool threadPool;
+    return &threadPool;
+}
+
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <ideal_export.h>
+
+namespace IdealCore {
+
+/**
+  * @class ThreadPool thread_pool.h core/thread_pool.h
+  *
+  * A fixed set of worker threads that run the tasks given to them, in the order they were given.
+  *
+  * @code
+  * class MyTask : public ThreadPool::Task {
+  *     virtual void run() { ... }
+  * };
+  * ThreadPool::globalInstance()->start(new MyTask);
+  * @endcode
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT ThreadPool
+{
+public:
+    /**
+      * @class Task thread_pool.h core/thread_pool.h
+      *
+      * A unit of work run by a thread pool. The pool deletes it after it is run.
+      */
+    class IDEAL_EXPORT Task
+    {
+        friend class ThreadPool;
+
+    public:
+        Task();
+        virtual ~Task();
+
+        /**
+          * Executed on one of the worker threads.
+          */
+        virtual void run() = 0;
+
+    private:
+        Task *m_next;
+    };
+
+    /**
+      * Creates a pool with @p threadCount workers. If @p threadCount is 0, as many workers as
+      * hardware threads are created.
+      */
+    ThreadPool(size_t threadCount = 0);
+
+    /**
+      * Runs the tasks that were not run yet and stops the workers.
+      */
+    virtual ~ThreadPool();
+
+    /**
+      * Queues @p task to be run by one of the workers. The pool takes its ownership.
+      */
+    void start(Task *task);
+
+    /**
+      * @return The number of workers of this pool.
+      */
+    size_t threadCount() const;
+
+    /**
+      * @return A pool shared by the whole library, with as many workers as hardware threads.
+      */
+    static ThreadPool *globalInstance();
+
+private:
+    ThreadPool(const ThreadPool &threadPool);
+    ThreadPool &operator=(const ThreadPool &threadPool);
+
+    class Private;
+    class PrivateImpl;
+    Private *d;
+};
+
+}
+
+#endif //THREAD_POOL_H
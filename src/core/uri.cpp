@@ -20,14 +20,26 @@
 
 #include "uri.h"
 #include "stack.h"
+#include "private/uri_parser_p.h"
+#include "private/idna_p.h"
 
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sched.h>
+#include <atomic>
 
 namespace IdealCore {
 
 class Uri::Private
 {
 public:
+    enum State {
+        Uninitialized = 0,
+        Initializing,
+        Initialized
+    };
+
     Private();
     virtual ~Private();
 
@@ -45,7 +57,9 @@ public:
     String getHex(Char ch) const;
     String undoHex(const String &uri) const;
 
+    void ensureInitialized();
     void initializeContents();
+    void precalculateSizes();
     void reconstructUri();
 
     void constructPath();
@@ -69,13 +83,11 @@ public:
     void parsePort();
     bool parsePctEncoded();
     bool parseIPLiteral();
-    bool parseIPv4Address();
+    bool parseIPv4Address(iuint8 *address);
     void parseRegName();
-    bool parseIPv6Address();
+    bool parseIPv6Address(iuint8 *address);
     bool parseIPvFuture();
-    bool parseH16();
-    bool parseLs32();
-    bool parseDecOctet();
+    bool parseDecOctet(iuint8 &octet);
     bool parsePathNoScheme();
     void parseSegment();
     bool parseSegmentNz();
@@ -93,14 +105,17 @@ public:
     String  m_userInfo;
     String  m_username;
     String  m_password;
-    String  m_host;
-    iint32  m_port;
+    String      m_host;
+    HostAddress m_hostAddress;
+    iint32      m_port;
     String  m_path;
     String  m_query;
     String  m_fragment;
+    bool    m_hasAuthority;
     bool    m_isValid;
-    size_t  m_refs;
-    bool    m_initialized;
+
+    std::atomic<size_t>  m_refs;
+    std::atomic<iint32>  m_state;
 
     static Private *m_privateEmpty;
 };
@@ -174,9 +189,10 @@ Uri::Private::Private()
     , m_parserPos(0)
     , m_parserLevelUp(0)
     , m_port(-1)
+    , m_hasAuthority(false)
     , m_isValid(false)
     , m_refs(1)
-    , m_initialized(false)
+    , m_state(Uninitialized)
 {
 }
 
@@ -193,32 +209,30 @@ Uri::Private *Uri::Private::copy() const
     privateCopy->m_username = m_username;
     privateCopy->m_password = m_password;
     privateCopy->m_host = m_host;
+    privateCopy->m_hostAddress = m_hostAddress;
     privateCopy->m_port = m_port;
     privateCopy->m_path = m_path;
     privateCopy->m_query = m_query;
     privateCopy->m_fragment = m_fragment;
+    privateCopy->m_hasAuthority = m_hasAuthority;
     privateCopy->m_isValid = m_isValid;
-    privateCopy->m_initialized = m_initialized;
+    privateCopy->m_state.store(m_state.load(std::memory_order_acquire), std::memory_order_relaxed);
     return privateCopy;
 }
 
 void Uri::Private::copyAndDetach(Uri *uri)
 {
-    if (m_refs > 1) {
+    if (m_refs.load(std::memory_order_acquire) > 1) {
         uri->d = copy();
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     }
 }
 
 void Uri::Private::newAndDetach(Uri *uri)
 {
-    if (m_refs > 1) {
+    if (m_refs.load(std::memory_order_acquire) > 1) {
         uri->d = new Private;
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     } else {
         clearContents();
     }
@@ -236,44 +250,40 @@ void Uri::Private::clearContentsKeepUri()
     m_username.clear();
     m_password.clear();
     m_host.clear();
+    m_hostAddress = HostAddress();
     m_port = -1;
     m_path.clear();
     m_query.clear();
     m_fragment.clear();
+    m_hasAuthority = false;
     m_isValid = false;
-    m_initialized = false;
 }
 
 void Uri::Private::clearContents()
 {
     clearContentsKeepUri();
     m_uri.clear();
+    m_state.store(Uninitialized, std::memory_order_relaxed);
 }
 
 void Uri::Private::ref()
 {
-    ++m_refs;
+    m_refs.fetch_add(1, std::memory_order_relaxed);
 }
 
 void Uri::Private::deref()
 {
-    --m_refs;
-    if (!m_refs) {
-        if (this == m_privateEmpty) {
-            m_privateEmpty = 0;
-        }
+    if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
         delete this;
     }
 }
 
 Uri::Private *Uri::Private::empty()
 {
-    if (!m_privateEmpty) {
-        m_privateEmpty = new Private;
-    } else {
-        m_privateEmpty->ref();
-    }
-    return m_privateEmpty;
+    // Holds a reference of its own, so it is never released
+    static Private *const privateEmpty = m_privateEmpty = new Private;
+    privateEmpty->ref();
+    return privateEmpty;
 }
 
 String Uri::Private::getHex(Char ch) const
@@ -350,9 +360,25 @@ String Uri::Private::undoHex(const String &uri) const
     return res;
 }
 
+void Uri::Private::ensureInitialized()
+{
+    if (IDEAL_LIKELY(m_state.load(std::memory_order_acquire) == Initialized)) {
+        return;
+    }
+    iint32 expected = Uninitialized;
+    if (m_state.compare_exchange_strong(expected, Initializing, std::memory_order_acquire)) {
+        initializeContents();
+        m_state.store(Initialized, std::memory_order_release);
+        return;
+    }
+    // Other thread is parsing this very same URI. Parsing is short, so just wait for it.
+    while (m_state.load(std::memory_order_acquire) != Initialized) {
+        sched_yield();
+    }
+}
+
 void Uri::Private::initializeContents()
 {
-    m_initialized = true;
     m_isValid = parseURIReference() && m_parserPos == m_uri.size();
     if (!m_isValid) {
         clearContentsKeepUri();
@@ -363,6 +389,22 @@ void Uri::Private::initializeContents()
         }
         reconstructUri();
     }
+    precalculateSizes();
+}
+
+void Uri::Private::precalculateSizes()
+{
+    // String calculates its size lazily. Do it now, so readers sharing these strings among threads
+    // never write to them.
+    m_uri.size();
+    m_scheme.size();
+    m_userInfo.size();
+    m_username.size();
+    m_password.size();
+    m_host.size();
+    m_path.size();
+    m_query.size();
+    m_fragment.size();
 }
 
 void Uri::Private::reconstructUri()
@@ -370,22 +412,35 @@ void Uri::Private::reconstructUri()
     m_uri.clear();
     if (!m_scheme.empty()) {
         m_uri += m_scheme;
-        m_uri += "://";
-    }
-    if (!m_userInfo.empty()) {
-        m_uri += m_userInfo;
-        m_uri += '@';
+        m_uri += ':';
     }
-    if (!m_host.empty()) {
-        m_uri += m_host;
+    if (m_hasAuthority) {
+        m_uri += "//";
+        if (!m_userInfo.empty()) {
+            m_uri += m_userInfo;
+            m_uri += '@';
+        }
+        if (m_hostAddress.protocol() == HostAddress::IPv6) {
+            m_uri += '[';
+            m_uri += m_host;
+            m_uri += ']';
+        } else {
+            m_uri += m_host;
+        }
+        if (m_port != -1) {
+            m_uri += ':';
+            m_uri += String::number(m_port);
+        }
     }
     if (!m_path.empty()) {
         m_uri += m_path;
     }
     if (!m_query.empty()) {
+        m_uri += '?';
         m_uri += m_query;
     }
     if (!m_fragment.empty()) {
+        m_uri += '#';
         m_uri += m_fragment;
     }
 }
@@ -471,6 +526,7 @@ bool Uri::Private::parseHierPart()
 {
     if (expectChar('/')) {
         if (expectChar('/')) {
+            m_hasAuthority = true;
             parseAuthority();
             parsePathAbempty();
             return true;
@@ -506,6 +562,7 @@ void Uri::Private::parseQuery()
             ++m_parserPos;
             continue;
         }
+        m_query = m_parserAux;
         return;
     }
 }
@@ -523,6 +580,7 @@ void Uri::Private::parseFragment()
             ++m_parserPos;
             continue;
         }
+        m_fragment = m_parserAux;
         return;
     }
 }
@@ -534,6 +592,9 @@ void Uri::Private::parseAuthority()
     parseUserinfo();
     if (!expectChar('@')) {
         m_parserPos = parserOldPos;
+        m_userInfo.clear();
+        m_username.clear();
+        m_password.clear();
     }
     parseHost();
     if (expectChar(':')) {
@@ -644,6 +705,7 @@ bool Uri::Private::parseRelativePart()
 {
     if (expectChar('/')) {
         if (expectChar('/')) {
+            m_hasAuthority = true;
             parseAuthority();
             parsePathAbempty();
             return true;
@@ -733,9 +795,16 @@ void Uri::Private::parseHost()
         return;
     }
     m_parserPos = parserOldPos;
-    if (parseIPv4Address()) {
-        m_host = m_parserAux;
-        return;
+    m_parserAux.clear();
+    iuint8 address[4];
+    if (parseIPv4Address(address)) {
+        // "1.2.3.4.example" is a reg-name, not an IPv4 address followed by garbage
+        const Char curr = m_uri[m_parserPos];
+        if (!curr.value() || curr == ':' || curr == '/' || curr == '?' || curr == '#') {
+            m_hostAddress = HostAddress((address[0] << 24) | (address[1] << 16) | (address[2] << 8) | address[3]);
+            m_host = m_parserAux;
+            return;
+        }
     }
     m_parserPos = parserOldPos;
     parseRegName();
@@ -797,10 +866,12 @@ bool Uri::Private::parseIPLiteral()
         return false;
     }
     const size_t parserOldPos = m_parserPos;
-    if (parseIPv6Address()) {
+    iuint8 address[16];
+    if (parseIPv6Address(address)) {
         if (!expectChar(']')) {
             return false;
         }
+        m_hostAddress = HostAddress(address);
         return true;
     }
     m_parserPos = parserOldPos;
@@ -813,32 +884,18 @@ bool Uri::Private::parseIPLiteral()
     return false;
 }
 
-bool Uri::Private::parseIPv4Address()
+bool Uri::Private::parseIPv4Address(iuint8 *address)
 {
-    m_parserAux.clear();
-    if (!parseDecOctet()) {
-        return false;
-    }
-    if (!expectChar('.')) {
-        return false;
-    }
-    m_parserAux += '.';
-    if (!parseDecOctet()) {
-        return false;
-    }
-    if (!expectChar('.')) {
-        return false;
-    }
-    m_parserAux += '.';
-    if (!parseDecOctet()) {
-        return false;
-    }
-    if (!expectChar('.')) {
-        return false;
-    }
-    m_parserAux += '.';
-    if (!parseDecOctet()) {
-        return false;
+    for (size_t i = 0; i < 4; ++i) {
+        if (i) {
+            if (!expectChar('.')) {
+                return false;
+            }
+            m_parserAux += '.';
+        }
+        if (!parseDecOctet(address[i])) {
+            return false;
+        }
     }
     return true;
 }
@@ -868,284 +925,26 @@ void Uri::Private::parseRegName()
     }
 }
 
-bool Uri::Private::parseIPv6Address()
+bool Uri::Private::parseIPv6Address(iuint8 *address)
 {
-    m_parserAux.clear();
-    const size_t parserOldPos = m_parserPos;
-    {
-        // 6( h16 ":" ) ls32
-        bool parse = true;
-        for (size_t i = 0; i < 6; ++i) {
-            if (!parseH16()) {
-                parse = false;
-                break;
-            }
-            if (!expectChar(':')) {
-                parse = false;
-                break;
-            } else {
-                m_parserAux += ':';
-            }
-        }
-        if (parse) {
-            if (parseLs32()) {
-                return true;
-            }
-        }
-    }
-    m_parserPos = parserOldPos;
-    m_parserAux.clear();
-    {
-        // "::" 5( h16 ":" ) ls32
-        if (expectChar(':') && expectChar(':')) {
-            m_parserAux += ':';
-            m_parserAux += ':';
-            bool parse = true;
-            for (size_t i = 0; i < 5; ++i) {
-                if (!parseH16()) {
-                    parse = false;
-                    break;
-                }
-                if (!expectChar(':')) {
-                    parse = false;
-                    break;
-                } else {
-                    m_parserAux += ':';
-                }
-            }
-            if (parse) {
-                if (parseLs32()) {
-                    return true;
-                }
-            }
-        }
-    }
-    m_parserPos = parserOldPos;
-    m_parserAux.clear();
-    {
-        // [ h16 ] "::" 4( h16 ":" ) ls32
-        const bool hasColon = expectChar(':');
-        bool parse = true;
-        if (!hasColon) {
-            parse = parseH16();
-        }
-        if (parse && expectChar(':') && (hasColon || expectChar(':'))) {
-            m_parserAux += ':';
-            m_parserAux += ':';
-            bool parse = true;
-            for (size_t i = 0; i < 4; ++i) {
-                if (!parseH16()) {
-                    parse = false;
-                    break;
-                }
-                if (!expectChar(':')) {
-                    parse = false;
-                    break;
-                } else {
-                    m_parserAux += ':';
-                }
-            }
-            if (parse) {
-                if (parseLs32()) {
-                    return true;
-                }
-            }
-        }
-    }
-    m_parserPos = parserOldPos;
-    m_parserAux.clear();
-    {
-        // [ *1( h16 ":" ) h16 ] "::" 3( h16 ":" ) ls32
-        const bool hasColon = expectChar(':');
-        bool parse = true;
-        if (!hasColon) {
-            parse = parseH16();
-            if (parse && expectChar(':')) {
-                m_parserAux += ':';
-                parse = parseH16();
-            }
-        }
-        if (parse && expectChar(':') && (hasColon || expectChar(':'))) {
-            m_parserAux += ':';
-            m_parserAux += ':';
-            bool parse = true;
-            for (size_t i = 0; i < 3; ++i) {
-                if (!parseH16()) {
-                    parse = false;
-                    break;
-                }
-                if (!expectChar(':')) {
-                    parse = false;
-                    break;
-                } else {
-                    m_parserAux += ':';
-                }
-            }
-            if (parse) {
-                if (parseLs32()) {
-                    return true;
-                }
-            }
-        }
-
-    }
-    m_parserPos = parserOldPos;
-    m_parserAux.clear();
-    {
-        // [ *2( h16 ":" ) h16 ] "::" 2( h16 ":" ) ls32
-        const bool hasColon = expectChar(':');
-        bool parse = true;
-        if (!hasColon) {
-            for (size_t i = 0; i < 2; ++i) {
-                if (!parseH16()) {
-                    parse = false;
-                    break;
-                }
-                if (!expectChar(':')) {
-                    parse = false;
-                    break;
-                } else {
-                    m_parserAux += ':';
-                }
-            }
-            if (parse) {
-                parse = parseH16();
-            }
-        }
-        if (parse && expectChar(':') && (hasColon || expectChar(':'))) {
-            m_parserAux += ':';
-            m_parserAux += ':';
-            bool parse = true;
-            for (size_t i = 0; i < 2; ++i) {
-                if (!parseH16()) {
-                    parse = false;
-                    break;
-                }
-                if (!expectChar(':')) {
-                    parse = false;
-                    break;
-                } else {
-                    m_parserAux += ':';
-                }
-            }
-            if (parse) {
-                if (parseLs32()) {
-                    return true;
-                }
-            }
-        }
-
-    }
-    m_parserPos = parserOldPos;
-    m_parserAux.clear();
-    {
-        // [ *3( h16 ":" ) h16 ] "::" h16 ":" ls32
-        bool hasColon = false;
-        if (parseH16()) {
-            for (size_t i = 0; i < 3; ++i) {
-                if (!expectChar(':')) {
-                    break;
-                }
-                m_parserAux += ':';
-                if (!parseH16()) {
-                    hasColon = true;
-                    break;
-                }
-            }
-        }
-        if (expectChar(':') && (hasColon || expectChar(':'))) {
-            m_parserAux += ':';
-            if (!hasColon) {
-                m_parserAux += ':';
-            }
-            if (parseH16() && expectChar(':')) {
-                m_parserAux += ':';
-                if (parseLs32()) {
-                  return true;
-                }
-            }
-        }
-    }
-    m_parserPos = parserOldPos;
-    m_parserAux.clear();
-    {
-        // [ *4( h16 ":" ) h16 ] "::" ls32
-        bool hasColon = false;
-        if (parseH16()) {
-            for (size_t i = 0; i < 4; ++i) {
-                if (!expectChar(':')) {
-                    break;
-                }
-                m_parserAux += ':';
-                if (!parseH16()) {
-                    hasColon = true;
-                    break;
-                }
-            }
-        }
-        if (expectChar(':') && (hasColon || expectChar(':'))) {
-            m_parserAux += ':';
-            if (!hasColon) {
-                m_parserAux += ':';
-            }
-            if (parseLs32()) {
-                return true;
-            }
-        }
-    }
-    m_parserPos = parserOldPos;
-    m_parserAux.clear();
-    {
-        // [ *5( h16 ":" ) h16 ] "::" h16
-        bool hasColon = false;
-        if (parseH16()) {
-            for (size_t i = 0; i < 5; ++i) {
-                if (!expectChar(':')) {
-                    break;
-                }
-                m_parserAux += ':';
-                if (!parseH16()) {
-                    hasColon = true;
-                    break;
-                }
-            }
-        }
-        if (expectChar(':') && (hasColon || expectChar(':'))) {
-            m_parserAux += ':';
-            if (!hasColon) {
-                m_parserAux += ':';
-            }
-            if (parseH16()) {
-                return true;
-            }
+    // "ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255" is the longest IPv6 address
+    ichar buffer[46];
+    size_t size = 0;
+    for (; size < sizeof(buffer) - 1; ++size) {
+        const iuint32 currValue = m_uri[m_parserPos + size].value();
+        if (!currValue || currValue > 127) {
+            break;
         }
+        buffer[size] = currValue;
     }
-    m_parserPos = parserOldPos;
-    m_parserAux.clear();
-    {
-        // [ *6( h16 ":" ) h16 ] "::"
-        bool hasColon = false;
-        if (parseH16()) {
-            for (size_t i = 0; i < 6; ++i) {
-                if (!expectChar(':')) {
-                    break;
-                }
-                m_parserAux += ':';
-                if (!parseH16()) {
-                    hasColon = true;
-                    break;
-                }
-            }
-        }
-        if (expectChar(':') && (hasColon || expectChar(':'))) {
-            m_parserAux += ':';
-            if (!hasColon) {
-                m_parserAux += ':';
-            }
-            return true;
-        }
+    buffer[size] = '\0';
+    size_t consumed;
+    if (!UriParser::parseIPv6Address(buffer, size, address, consumed)) {
+        return false;
     }
-    return false;
+    m_parserAux = String(buffer, consumed);
+    m_parserPos += consumed;
+    return true;
 }
 
 bool Uri::Private::parseIPvFuture()
@@ -1180,63 +979,25 @@ bool Uri::Private::parseIPvFuture()
     return false;
 }
 
-bool Uri::Private::parseH16()
+bool Uri::Private::parseDecOctet(iuint8 &octet)
 {
-    for (size_t i = 0; i < 4; ++i) {
-        const Char curr = m_uri[m_parserPos];
-        const size_t currValue = curr.value();
-        if (!currValue || currValue > 127 || !isHexdig[currValue]) {
-            return i;
-        }
-        m_parserAux += curr;
-        ++m_parserPos;
-    }
-    return true;
-}
-
-bool Uri::Private::parseLs32()
-{
-    const size_t parserOldPos = m_parserPos;
-    if (parseH16()) {
-        if (!expectChar(':')) {
-            return false;
-        }
-        if (parseH16()) {
-            return true;
-        }
-        return false;
-    }
-    m_parserPos = parserOldPos;
-    if (parseIPv4Address()) {
-        return true;
-    }
-    return false;
-}
-
-bool Uri::Private::parseDecOctet()
-{
-    String decOctet;
-    for (size_t i = 0; i < 3; ++i) {
-        const Char currChar = m_uri[m_parserPos];
-        const iuint32 currValue = currChar.value();
-        if (currValue && currValue < 128 && isDigit[currValue]) {
-            decOctet += currChar;
-            ++m_parserPos;
-        } else {
+    // dec-octet does not allow leading zeros, so "01" is not a valid octet
+    iuint32 value = 0;
+    size_t digits = 0;
+    for (; digits < 3; ++digits) {
+        const iuint32 currValue = m_uri[m_parserPos].value();
+        if (!currValue || currValue > 127 || !isDigit[currValue] || (digits == 1 && !value)) {
             break;
         }
+        value = value * 10 + (currValue - '0');
+        m_parserAux += Char(currValue);
+        ++m_parserPos;
     }
-    if (decOctet.empty()) {
+    if (!digits || value > 255) {
         return false;
-    } else {
-        const size_t retValue = decOctet.toInt();
-        if (retValue < 256) {
-            m_parserAux += decOctet;
-            return true;
-        } else {
-            return false;
-        }
     }
+    octet = value;
+    return true;
 }
 
 bool Uri::Private::parsePathNoScheme()
@@ -1403,65 +1164,92 @@ Uri::~Uri()
 
 String Uri::scheme() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     return d->m_scheme;
 }
 
 String Uri::userInfo() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     return d->m_userInfo;
 }
 
 String Uri::username() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     return d->m_username;
 }
 
 String Uri::password() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     return d->m_password;
 }
 
 String Uri::host() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
+    d->ensureInitialized();
+    return d->m_host;
+}
+
+HostAddress Uri::hostAddress() const
+{
+    d->ensureInitialized();
+    return d->m_hostAddress;
+}
+
+String Uri::asciiHost() const
+{
+    d->ensureInitialized();
+    const ichar *const host = d->m_host.data();
+    const size_t hostLength = strlen(host);
+    for (size_t i = 0; i < hostLength; ++i) {
+        if ((iuint8) host[i] >= 0x80) {
+            ichar asciiHost[Idna::maxAsciiLength + 1];
+            if (!Idna::toAscii(host, hostLength, asciiHost, sizeof(asciiHost))) {
+                return String();
+            }
+            return String(asciiHost);
+        }
     }
     return d->m_host;
 }
 
+String Uri::fromAsciiHost(const String &asciiHost)
+{
+    const ichar *const host = asciiHost.data();
+    const ichar *label = host;
+    while (strncasecmp(label, "xn--", 4)) {
+        label = strchr(label, '.');
+        if (!label) {
+            return asciiHost;
+        }
+        ++label;
+    }
+    const size_t hostLength = strlen(host);
+    const size_t capacity = hostLength * 4 + 1;
+    ichar *const unicodeHost = (ichar*) malloc(capacity);
+    const size_t unicodeHostLength = Idna::toUnicode(host, hostLength, unicodeHost, capacity);
+    const String res = unicodeHostLength ? String(unicodeHost) : asciiHost;
+    free(unicodeHost);
+    return res;
+}
+
 iint32 Uri::port() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     return d->m_port;
 }
 
 String Uri::path() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     return d->m_path;
 }
 
 String Uri::filename() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     const size_t sepPos = d->m_path.rfind('/');
     if (sepPos != String::npos && sepPos < d->m_path.size() - 1) {
         return d->m_path.substr(sepPos + 1);
@@ -1471,43 +1259,37 @@ String Uri::filename() const
 
 String Uri::query() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     return d->m_query;
 }
 
 String Uri::fragment() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     return d->m_fragment;
 }
 
 String Uri::uri() const
 {
+    d->ensureInitialized();
     return d->m_uri;
 }
 
 bool Uri::isValid() const
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     return d->m_isValid;
 }
 
 bool Uri::empty() const
 {
+    d->ensureInitialized();
     return d->m_uri.empty();
 }
 
 Uri &Uri::dirUp()
 {
-    if (!d->m_initialized) {
-        d->initializeContents();
-    }
+    d->ensureInitialized();
     if (d == Private::m_privateEmpty || d->m_path.empty()) {
         return *this;
     }
@@ -1523,6 +1305,7 @@ Uri &Uri::dirUp()
             d->m_path = '/';
         }
         d->reconstructUri();
+        d->precalculateSizes();
     }
     return *this;
 }
@@ -1540,10 +1323,11 @@ Uri &Uri::operator=(const Uri &uri)
 
 Uri &Uri::operator=(const String &uri)
 {
-    if (uri == d->m_uri) {
+    if (uri == this->uri()) {
         return *this;
     }
     if (uri.empty()) {
+        d->deref();
         d = Private::empty();
     } else {
         d->newAndDetach(this);
@@ -1567,6 +1351,8 @@ bool Uri::operator==(const Uri &uri) const
     if (d == uri.d) {
         return true;
     }
+    d->ensureInitialized();
+    uri.d->ensureInitialized();
     return d->m_uri == uri.d->m_uri;
 }
 
@@ -23,6 +23,7 @@
 
 #include <ideal_export.h>
 #include <core/ideal_string.h>
+#include <core/host_address.h>
 
 namespace IdealCore {
 
@@ -70,6 +71,42 @@ public:
       */
     String host() const;
 
+    /**
+      * @return The host specified on the URI in binary form, if the host is an IPv4 or IPv6
+      *         address. A null address if no host was specified or if the host is a name.
+      *
+      * @note The address is captured while parsing, so there is no need to parse host() again.
+      */
+    HostAddress hostAddress() const;
+
+    /**
+      * @return The host specified on the URI in its ASCII compatible form (RFC 5891), as it has to
+      *         be sent to a DNS server. Each label with non ASCII characters is mapped (lowercased
+      *         and with fullwidth characters and alternative dots replaced) and encoded with
+      *         Punycode, prefixed with "xn--":
+      *
+      * @code
+      * Uri uri("http://bücher.example/");
+      * uri.asciiHost(); // "xn--bcher-kva.example"
+      * @endcode
+      *
+      *         An empty string if no host was specified or if the host cannot be converted (it
+      *         is not valid UTF-8 or a label is too long).
+      *
+      * @note If the host only contains ASCII characters, it is returned unchanged without any
+      *       allocation.
+      */
+    String asciiHost() const;
+
+    /**
+      * @return @p asciiHost with all its "xn--" labels converted back to Unicode. Labels that are
+      *         not valid Punycode are left unchanged.
+      *
+      * @note If @p asciiHost contains no "xn--" label, it is returned unchanged without any
+      *       allocation.
+      */
+    static String fromAsciiHost(const String &asciiHost);
+
     /**
       * @return The port specified on the URI. -1 if no port specified.
       */
@@ -0,0 +1,301 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "uri_batch.h"
+#include "private/uri_parser_p.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+namespace IdealCore {
+
+static const iuint32 componentAbsent = 0xffffffff;
+
+class UriBatch::Private
+{
+public:
+    Private();
+    ~Private();
+
+    void clearContents();
+    void allocate(size_t arenaSize, size_t count);
+    void parseEntries(size_t threads);
+    void parseRange(size_t first, size_t last);
+
+    ichar   *m_arena;
+    size_t   m_count;
+    size_t  *m_uriOffset;
+    size_t  *m_uriLength;
+    // Component offsets are relative to the beginning of their entry, so 32 bits are enough
+    iuint32 *m_begin[UriParser::ComponentCount];
+    iuint32 *m_length[UriParser::ComponentCount];
+    iint32  *m_port;
+    bool    *m_valid;
+};
+
+UriBatch::Private::Private()
+    : m_arena(0)
+    , m_count(0)
+    , m_uriOffset(0)
+    , m_uriLength(0)
+    , m_port(0)
+    , m_valid(0)
+{
+    for (size_t i = 0; i < UriParser::ComponentCount; ++i) {
+        m_begin[i] = 0;
+        m_length[i] = 0;
+    }
+}
+
+UriBatch::Private::~Private()
+{
+    clearContents();
+}
+
+void UriBatch::Private::clearContents()
+{
+    free(m_arena);
+    free(m_uriOffset);
+    free(m_uriLength);
+    for (size_t i = 0; i < UriParser::ComponentCount; ++i) {
+        free(m_begin[i]);
+        free(m_length[i]);
+        m_begin[i] = 0;
+        m_length[i] = 0;
+    }
+    free(m_port);
+    free(m_valid);
+    m_arena = 0;
+    m_count = 0;
+    m_uriOffset = 0;
+    m_uriLength = 0;
+    m_port = 0;
+    m_valid = 0;
+}
+
+void UriBatch::Private::allocate(size_t arenaSize, size_t count)
+{
+    clearContents();
+    m_arena = (ichar*) malloc(arenaSize + 1);
+    m_arena[arenaSize] = '\0';
+    m_count = count;
+    m_uriOffset = (size_t*) malloc(count * sizeof(size_t));
+    m_uriLength = (size_t*) malloc(count * sizeof(size_t));
+    for (size_t i = 0; i < UriParser::ComponentCount; ++i) {
+        m_begin[i] = (iuint32*) malloc(count * sizeof(iuint32));
+        m_length[i] = (iuint32*) malloc(count * sizeof(iuint32));
+    }
+    m_port = (iint32*) malloc(count * sizeof(iint32));
+    m_valid = (bool*) malloc(count * sizeof(bool));
+}
+
+void UriBatch::Private::parseEntries(size_t threads)
+{
+    if (!threads) {
+        threads = std::thread::hardware_concurrency();
+    }
+    // Starting a thread costs more than parsing a few hundred URIs
+    const size_t minEntriesPerThread = 1024;
+    if (threads > m_count / minEntriesPerThread) {
+        threads = m_count / minEntriesPerThread;
+    }
+    if (threads < 2) {
+        parseRange(0, m_count);
+        return;
+    }
+    // Each thread writes to a disjoint range of rows of every column, so no locking is needed
+    std::thread *const workers = new std::thread[threads - 1];
+    const size_t entriesPerThread = m_count / threads;
+    for (size_t i = 0; i < threads - 1; ++i) {
+        workers[i] = std::thread(&Private::parseRange, this, i * entriesPerThread,
+                                 (i + 1) * entriesPerThread);
+    }
+    parseRange((threads - 1) * entriesPerThread, m_count);
+    for (size_t i = 0; i < threads - 1; ++i) {
+        workers[i].join();
+    }
+    delete[] workers;
+}
+
+void UriBatch::Private::parseRange(size_t first, size_t last)
+{
+    UriParser::Components components;
+    for (size_t i = first; i < last; ++i) {
+        const size_t uriOffset = m_uriOffset[i];
+        UriParser uriParser(m_arena + uriOffset, m_uriLength[i]);
+        m_valid[i] = uriParser.parseUriReference(components);
+        if (!m_valid[i]) {
+            components.clear();
+        }
+        for (size_t j = 0; j < UriParser::ComponentCount; ++j) {
+            if (components.begin[j] == UriParser::npos) {
+                m_begin[j][i] = componentAbsent;
+                m_length[j][i] = 0;
+            } else {
+                m_begin[j][i] = components.begin[j];
+                m_length[j][i] = components.length[j];
+            }
+        }
+        m_port[i] = components.port;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+UriBatch::UriBatch()
+    : d(new Private)
+{
+}
+
+UriBatch::~UriBatch()
+{
+    delete d;
+}
+
+void UriBatch::parse(const Vector<String> &uris, size_t threads)
+{
+    const size_t count = uris.count();
+    size_t arenaSize = 0;
+    for (size_t i = 0; i < count; ++i) {
+        arenaSize += strlen(uris[i].data()) + 1;
+    }
+    d->allocate(arenaSize, count);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const ichar *const uri = uris[i].data();
+        const size_t uriLength = strlen(uri);
+        memcpy(d->m_arena + offset, uri, uriLength + 1);
+        d->m_uriOffset[i] = offset;
+        d->m_uriLength[i] = uriLength;
+        offset += uriLength + 1;
+    }
+    d->parseEntries(threads);
+}
+
+void UriBatch::parse(const ichar *buffer, size_t size, size_t threads)
+{
+    // Count lines first, so all columns are allocated once
+    size_t count = 0;
+    const ichar *curr = buffer;
+    const ichar *const end = buffer + size;
+    while (curr < end) {
+        const ichar *const newLine = (const ichar*) memchr(curr, '\n', end - curr);
+        ++count;
+        if (!newLine) {
+            break;
+        }
+        curr = newLine + 1;
+    }
+    d->allocate(size, count);
+    memcpy(d->m_arena, buffer, size);
+    size_t i = 0;
+    size_t offset = 0;
+    while (offset < size) {
+        const ichar *const newLine = (const ichar*) memchr(d->m_arena + offset, '\n', size - offset);
+        size_t uriLength = newLine ? newLine - (d->m_arena + offset) : size - offset;
+        size_t next = offset + uriLength + 1;
+        if (uriLength && d->m_arena[offset + uriLength - 1] == '\r') {
+            --uriLength;
+        }
+        d->m_arena[offset + uriLength] = '\0';
+        d->m_uriOffset[i] = offset;
+        d->m_uriLength[i] = uriLength;
+        ++i;
+        offset = next;
+    }
+    d->parseEntries(threads);
+}
+
+void UriBatch::clear()
+{
+    d->clearContents();
+}
+
+size_t UriBatch::count() const
+{
+    return d->m_count;
+}
+
+bool UriBatch::isValid(size_t i) const
+{
+    return d->m_valid[i];
+}
+
+const ichar *UriBatch::arena() const
+{
+    return d->m_arena;
+}
+
+size_t UriBatch::uriOffset(size_t i) const
+{
+    return d->m_uriOffset[i];
+}
+
+size_t UriBatch::uriLength(size_t i) const
+{
+    return d->m_uriLength[i];
+}
+
+bool UriBatch::hasComponent(size_t i, Component component) const
+{
+    return d->m_begin[component][i] != componentAbsent;
+}
+
+size_t UriBatch::offset(size_t i, Component component) const
+{
+    const iuint32 begin = d->m_begin[component][i];
+    if (begin == componentAbsent) {
+        return d->m_uriOffset[i] + d->m_uriLength[i];
+    }
+    return d->m_uriOffset[i] + begin;
+}
+
+size_t UriBatch::length(size_t i, Component component) const
+{
+    return d->m_length[component][i];
+}
+
+String UriBatch::component(size_t i, Component component) const
+{
+    const size_t componentLength = d->m_length[component][i];
+    if (!componentLength) {
+        return String();
+    }
+    // String needs a nul terminated buffer
+    ichar *const res = (ichar*) malloc(componentLength + 1);
+    memcpy(res, d->m_arena + offset(i, component), componentLength);
+    res[componentLength] = '\0';
+    const String str(res);
+    free(res);
+    return str;
+}
+
+iint32 UriBatch::port(size_t i) const
+{
+    return d->m_port[i];
+}
+
+Uri UriBatch::uri(size_t i) const
+{
+    return Uri(d->m_arena + d->m_uriOffset[i]);
+}
+
+}
@@ -0,0 +1,160 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef URI_BATCH_H
+#define URI_BATCH_H
+
+#include <ideal_export.h>
+#include <core/ideal_string.h>
+#include <core/vector.h>
+#include <core/uri.h>
+
+namespace IdealCore {
+
+/**
+  * @class UriBatch uri_batch.h core/uri_batch.h
+  *
+  * This class parses a big amount of URIs at once. Instead of creating a Uri object (and its
+  * strings) for each one of them, all URIs are copied into one buffer and for each component only
+  * its offset and length inside that buffer are stored, in one array per component. Walking over a
+  * single component of all URIs (e.g. counting hosts) only touches that array.
+  *
+  * @code
+  * UriBatch batch;
+  * batch.parse(logContents, logSize, 0); // one URI per line, using all available cores
+  * for (size_t i = 0; i < batch.count(); ++i) {
+  *     if (batch.isValid(i) && batch.hasComponent(i, UriBatch::Host)) {
+  *         hostCount[batch.component(i, UriBatch::Host)] += 1;
+  *     }
+  * }
+  * @endcode
+  *
+  * Components are reported as they appear in the input: they are not normalized and percent
+  * encoded characters are not decoded. Use uri() to get a fully normalized Uri for a given entry.
+  *
+  * @note Each entry is validated against RFC 3986, accepting the same characters Uri does.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT UriBatch
+{
+public:
+    enum Component {
+        Scheme = 0,     ///< The scheme, without the ':'.
+        UserInfo,       ///< The user information, without the '@'.
+        Host,           ///< The host. IPv6 addresses are reported without brackets.
+        Port,           ///< The port digits, without the ':'.
+        Path,           ///< The path.
+        Query,          ///< The query, without the '?'.
+        Fragment        ///< The fragment, without the '#'.
+    };
+
+    UriBatch();
+    virtual ~UriBatch();
+
+    /**
+      * Parses all URIs in @p uris, replacing the previous contents of this batch.
+      *
+      * @param threads The number of threads the work will be split into. If 0, as many threads
+      *                as processors are available will be used.
+      */
+    void parse(const Vector<String> &uris, size_t threads = 1);
+
+    /**
+      * Parses the first @p size bytes of @p buffer, replacing the previous contents of this batch.
+      * Each line of @p buffer is considered a URI. Both "\n" and "\r\n" line endings are accepted.
+      *
+      * @param threads The number of threads the work will be split into. If 0, as many threads
+      *                as processors are available will be used.
+      */
+    void parse(const ichar *buffer, size_t size, size_t threads = 1);
+
+    /**
+      * Removes all entries from this batch.
+      */
+    void clear();
+
+    /**
+      * @return The number of entries in this batch.
+      */
+    size_t count() const;
+
+    /**
+      * @return Whether the entry @p i is a valid URI reference.
+      */
+    bool isValid(size_t i) const;
+
+    /**
+      * @return The buffer all offsets of this batch refer to.
+      */
+    const ichar *arena() const;
+
+    /**
+      * @return The offset of the entry @p i inside arena().
+      */
+    size_t uriOffset(size_t i) const;
+
+    /**
+      * @return The length in bytes of the entry @p i.
+      */
+    size_t uriLength(size_t i) const;
+
+    /**
+      * @return Whether the entry @p i has the component @p component. Note that a component can be
+      *         present and empty (e.g. the query of "http://host/?").
+      */
+    bool hasComponent(size_t i, Component component) const;
+
+    /**
+      * @return The offset of @p component of the entry @p i inside arena().
+      */
+    size_t offset(size_t i, Component component) const;
+
+    /**
+      * @return The length in bytes of @p component of the entry @p i. 0 if it is not present.
+      */
+    size_t length(size_t i, Component component) const;
+
+    /**
+      * @return A copy of @p component of the entry @p i. An empty string if it is not present.
+      */
+    String component(size_t i, Component component) const;
+
+    /**
+      * @return The port of the entry @p i. -1 if no port was specified.
+      */
+    iint32 port(size_t i) const;
+
+    /**
+      * @return A Uri object for the entry @p i.
+      */
+    Uri uri(size_t i) const;
+
+private:
+    UriBatch(const UriBatch &uriBatch);
+    UriBatch &operator=(const UriBatch &uriBatch);
+
+    class Private;
+    Private *d;
+};
+
+}
+
+#endif //URI_BATCH_H
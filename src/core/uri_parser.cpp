@@ -0,0 +1,455 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "private/uri_parser_p.h"
+
+#include <string.h>
+
+namespace IdealCore {
+
+enum CharClass {
+    Alpha       = 0x1,
+    Digit       = 0x2,
+    Hexdig      = 0x4,
+    Unreserved  = 0x8,
+    Subdelim    = 0x10,
+    Colon       = 0x20,
+    At          = 0x40,
+    Slash       = 0x80,
+    QuestionMark = 0x100,
+    SchemeExtra = 0x200,
+    Other       = 0x400 ///< Accepted only in Lenient mode
+};
+
+static const iuint32 schemeMask = Alpha | Digit | SchemeExtra;
+static const iuint32 userInfoMask = Unreserved | Subdelim | Colon;
+static const iuint32 regNameMask = Unreserved | Subdelim;
+static const iuint32 pcharMask = Unreserved | Subdelim | Colon | At;
+static const iuint32 pcharNoColonMask = Unreserved | Subdelim | At;
+static const iuint32 pathMask = pcharMask | Slash;
+static const iuint32 queryMask = pcharMask | Slash | QuestionMark;
+
+class CharClassTable
+{
+public:
+    CharClassTable()
+    {
+        memset(m_classes, 0, sizeof(m_classes));
+        for (iuint32 c = 'a'; c <= 'z'; ++c) {
+            m_classes[c] |= Alpha | Unreserved;
+            m_classes[c - 'a' + 'A'] |= Alpha | Unreserved;
+        }
+        for (iuint32 c = '0'; c <= '9'; ++c) {
+            m_classes[c] |= Digit | Hexdig | Unreserved;
+        }
+        for (iuint32 c = 'a'; c <= 'f'; ++c) {
+            m_classes[c] |= Hexdig;
+            m_classes[c - 'a' + 'A'] |= Hexdig;
+        }
+        const ichar *unreserved = "-._~";
+        for (const ichar *c = unreserved; *c; ++c) {
+            m_classes[(iuint8) *c] |= Unreserved;
+        }
+        const ichar *subdelims = "!$&'()*+,;=";
+        for (const ichar *c = subdelims; *c; ++c) {
+            m_classes[(iuint8) *c] |= Subdelim;
+        }
+        m_classes[(iuint8) ':'] |= Colon;
+        m_classes[(iuint8) '@'] |= At;
+        m_classes[(iuint8) '/'] |= Slash;
+        m_classes[(iuint8) '?'] |= QuestionMark;
+        m_classes[(iuint8) '+'] |= SchemeExtra;
+        m_classes[(iuint8) '-'] |= SchemeExtra;
+        m_classes[(iuint8) '.'] |= SchemeExtra;
+        const ichar *gendelims = ":/?#[]@";
+        for (iuint32 c = 1; c < 256; ++c) {
+            if (!m_classes[c] && c != '%' && !strchr(gendelims, c)) {
+                m_classes[c] |= Other;
+            }
+        }
+    }
+
+    iuint32 m_classes[256];
+};
+
+static const CharClassTable &charClasses()
+{
+    static const CharClassTable charClassTable;
+    return charClassTable;
+}
+
+static inline iuint32 hexValue(iuint32 c)
+{
+    // '0' - '9' are 0x30 - 0x39, 'A' - 'F' are 0x41 - 0x46 and 'a' - 'f' are 0x61 - 0x66
+    return (c & 0xf) + 9 * (c >> 6);
+}
+
+static bool parseIPv4Address(const ichar *str, size_t size, iuint8 *address, size_t &consumed)
+{
+    const iuint32 *const classes = charClasses().m_classes;
+    size_t pos = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        if (i) {
+            if (pos >= size || str[pos] != '.') {
+                return false;
+            }
+            ++pos;
+        }
+        // dec-octet does not allow leading zeros, so "01" is not a valid octet
+        iuint32 value = 0;
+        size_t digits = 0;
+        while (digits < 3 && pos < size && (classes[(iuint8) str[pos]] & Digit) && (!digits || value)) {
+            value = value * 10 + (str[pos] - '0');
+            ++digits;
+            ++pos;
+        }
+        if (!digits || value > 255) {
+            return false;
+        }
+        address[i] = value;
+    }
+    consumed = pos;
+    return true;
+}
+
+void UriParser::Components::clear()
+{
+    for (size_t i = 0; i < ComponentCount; ++i) {
+        begin[i] = npos;
+        length[i] = 0;
+    }
+    port = -1;
+}
+
+UriParser::UriParser(const ichar *str, size_t size, Mode mode)
+    : m_str(str)
+    , m_size(size)
+    , m_mode(mode)
+    , m_pos(0)
+{
+}
+
+bool UriParser::parseUriReference(Components &components)
+{
+    m_pos = 0;
+    if (parseUriAt(components) && m_pos == m_size) {
+        return true;
+    }
+    m_pos = 0;
+    return parseRelativeRef(components) && m_pos == m_size;
+}
+
+size_t UriParser::parseUri(Components &components)
+{
+    m_pos = 0;
+    if (!parseUriAt(components)) {
+        return 0;
+    }
+    return m_pos;
+}
+
+size_t UriParser::parseAuthorityPrefix(Components &components)
+{
+    m_pos = 0;
+    components.clear();
+    if (!parseAuthority(components)) {
+        return 0;
+    }
+    parsePath(components, true);
+    parseQueryAndFragment(components);
+    return m_pos;
+}
+
+bool UriParser::isUriCharacter(ichar c)
+{
+    const iuint8 uc = c;
+    return (charClasses().m_classes[uc] & (pathMask | QuestionMark)) || uc == '%' || uc == '#' ||
+           uc == '[' || uc == ']';
+}
+
+bool UriParser::parseIPv6Address(const ichar *str, size_t size, iuint8 *address, size_t &consumed)
+{
+    // All nine alternatives of the IPv6address rule are recognized in one pass: up to eight h16
+    // groups separated by ':', at most one "::" standing for one or more zero groups, and an
+    // optional IPv4 address taking the place of the last two groups.
+    const iuint32 *const classes = charClasses().m_classes;
+    size_t pos = 0;
+    size_t numGroups = 0;
+    size_t compressedAt = 0;
+    bool compressed = false;
+    bool groupExpected = true;
+    if (size >= 2 && str[0] == ':' && str[1] == ':') {
+        pos = 2;
+        compressed = true;
+        groupExpected = false;
+    }
+    while (numGroups < 8) {
+        iuint32 group = 0;
+        size_t digits = 0;
+        while (digits < 4 && pos + digits < size && (classes[(iuint8) str[pos + digits]] & Hexdig)) {
+            group = (group << 4) | hexValue(str[pos + digits]);
+            ++digits;
+        }
+        if (!digits) {
+            if (groupExpected) {
+                return false;
+            }
+            break;
+        }
+        if (pos + digits < size && str[pos + digits] == '.') {
+            size_t ipv4Length;
+            if (numGroups > 6 || !IdealCore::parseIPv4Address(str + pos, size - pos, address + numGroups * 2, ipv4Length)) {
+                return false;
+            }
+            pos += ipv4Length;
+            numGroups += 2;
+            groupExpected = false;
+            break;
+        }
+        pos += digits;
+        address[numGroups * 2] = group >> 8;
+        address[numGroups * 2 + 1] = group & 0xff;
+        ++numGroups;
+        groupExpected = false;
+        if (pos >= size || str[pos] != ':') {
+            break;
+        }
+        if (pos + 1 < size && str[pos + 1] == ':') {
+            if (compressed) {
+                return false;
+            }
+            pos += 2;
+            compressedAt = numGroups;
+            compressed = true;
+            continue;
+        }
+        ++pos;
+        groupExpected = true;
+    }
+    if (groupExpected) {
+        return false;
+    }
+    if (!compressed) {
+        if (numGroups != 8) {
+            return false;
+        }
+    } else {
+        if (numGroups > 7) {
+            return false;
+        }
+        const size_t tail = (numGroups - compressedAt) * 2;
+        memmove(address + 16 - tail, address + compressedAt * 2, tail);
+        memset(address + compressedAt * 2, 0, 16 - tail - compressedAt * 2);
+    }
+    consumed = pos;
+    return true;
+}
+
+bool UriParser::parseUriAt(Components &components)
+{
+    components.clear();
+    if (!parseScheme(components)) {
+        return false;
+    }
+    if (m_pos >= m_size || m_str[m_pos] != ':') {
+        return false;
+    }
+    ++m_pos;
+    if (m_pos + 1 < m_size && m_str[m_pos] == '/' && m_str[m_pos + 1] == '/') {
+        m_pos += 2;
+        if (!parseAuthority(components)) {
+            return false;
+        }
+    }
+    // path-abempty, path-absolute, path-rootless and path-empty are all sequences of pchar and
+    // '/' once the "//" case has been handled
+    parsePath(components, true);
+    parseQueryAndFragment(components);
+    return true;
+}
+
+bool UriParser::parseRelativeRef(Components &components)
+{
+    components.clear();
+    if (m_pos + 1 < m_size && m_str[m_pos] == '/' && m_str[m_pos + 1] == '/') {
+        m_pos += 2;
+        if (!parseAuthority(components)) {
+            return false;
+        }
+        parsePath(components, true);
+    } else {
+        // path-noscheme: its first segment cannot contain ':'
+        parsePath(components, m_pos < m_size && m_str[m_pos] == '/');
+    }
+    parseQueryAndFragment(components);
+    return true;
+}
+
+bool UriParser::parseScheme(Components &components)
+{
+    if (m_pos >= m_size || !(charClasses().m_classes[(iuint8) m_str[m_pos]] & Alpha)) {
+        return false;
+    }
+    const size_t begin = m_pos;
+    const iuint32 *const classes = charClasses().m_classes;
+    while (m_pos < m_size && (classes[(iuint8) m_str[m_pos]] & schemeMask)) {
+        ++m_pos;
+    }
+    components.begin[Scheme] = begin;
+    components.length[Scheme] = m_pos - begin;
+    return true;
+}
+
+bool UriParser::parseAuthority(Components &components)
+{
+    const size_t begin = m_pos;
+    scan(userInfoMask);
+    if (m_pos < m_size && m_str[m_pos] == '@') {
+        components.begin[UserInfo] = begin;
+        components.length[UserInfo] = m_pos - begin;
+        ++m_pos;
+    } else {
+        m_pos = begin;
+    }
+    if (!parseHost(components)) {
+        return false;
+    }
+    if (m_pos < m_size && m_str[m_pos] == ':') {
+        ++m_pos;
+        const size_t portBegin = m_pos;
+        iint32 port = 0;
+        while (m_pos < m_size && m_str[m_pos] >= '0' && m_str[m_pos] <= '9') {
+            if (port < 100000000) {
+                port = port * 10 + (m_str[m_pos] - '0');
+            }
+            ++m_pos;
+        }
+        components.begin[Port] = portBegin;
+        components.length[Port] = m_pos - portBegin;
+        components.port = m_pos > portBegin ? port : -1;
+    }
+    return true;
+}
+
+bool UriParser::parseHost(Components &components)
+{
+    if (m_pos < m_size && m_str[m_pos] == '[') {
+        ++m_pos;
+        const size_t begin = m_pos;
+        iuint8 address[16];
+        size_t consumed;
+        if (parseIPv6Address(m_str + m_pos, m_size - m_pos, address, consumed)) {
+            m_pos += consumed;
+        } else if (!parseIPvFuture()) {
+            return false;
+        }
+        if (m_pos >= m_size || m_str[m_pos] != ']') {
+            return false;
+        }
+        components.begin[Host] = begin;
+        components.length[Host] = m_pos - begin;
+        ++m_pos;
+        return true;
+    }
+    // IPv4address is a subset of reg-name, there is no need to tell them apart here
+    const size_t begin = m_pos;
+    scan(regNameMask);
+    components.begin[Host] = begin;
+    components.length[Host] = m_pos - begin;
+    return true;
+}
+
+bool UriParser::parseIPvFuture()
+{
+    const iuint32 *const classes = charClasses().m_classes;
+    if (m_pos >= m_size || (m_str[m_pos] != 'v' && m_str[m_pos] != 'V')) {
+        return false;
+    }
+    size_t pos = m_pos + 1;
+    const size_t versionBegin = pos;
+    while (pos < m_size && (classes[(iuint8) m_str[pos]] & Hexdig)) {
+        ++pos;
+    }
+    if (pos == versionBegin || pos >= m_size || m_str[pos] != '.') {
+        return false;
+    }
+    ++pos;
+    const size_t addressBegin = pos;
+    while (pos < m_size && (classes[(iuint8) m_str[pos]] & userInfoMask)) {
+        ++pos;
+    }
+    if (pos == addressBegin) {
+        return false;
+    }
+    m_pos = pos;
+    return true;
+}
+
+void UriParser::parsePath(Components &components, bool allowColon)
+{
+    const size_t begin = m_pos;
+    if (!allowColon) {
+        scan(pcharNoColonMask);
+        if (m_pos < m_size && m_str[m_pos] == '/') {
+            scan(pathMask);
+        }
+    } else if (components.begin[Host] == npos || (m_pos < m_size && m_str[m_pos] == '/')) {
+        scan(pathMask);
+    }
+    components.begin[Path] = begin;
+    components.length[Path] = m_pos - begin;
+}
+
+void UriParser::parseQueryAndFragment(Components &components)
+{
+    if (m_pos < m_size && m_str[m_pos] == '?') {
+        ++m_pos;
+        components.begin[Query] = m_pos;
+        components.length[Query] = scan(queryMask);
+    }
+    if (m_pos < m_size && m_str[m_pos] == '#') {
+        ++m_pos;
+        components.begin[Fragment] = m_pos;
+        components.length[Fragment] = scan(queryMask);
+    }
+}
+
+size_t UriParser::scan(iuint32 mask)
+{
+    const iuint32 *const classes = charClasses().m_classes;
+    if (m_mode == Lenient) {
+        mask |= Other;
+    }
+    const size_t begin = m_pos;
+    while (m_pos < m_size) {
+        const iuint8 c = m_str[m_pos];
+        if (classes[c] & mask) {
+            ++m_pos;
+        } else if (c == '%' && m_pos + 2 < m_size &&(classes[(iuint8) m_str[m_pos + 1]] & Hexdig) &&
+                   (classes[(iuint8) m_str[m_pos + 2]] & Hexdig)) {
+            m_pos += 3;
+        } else {
+            break;
+        }
+    }
+    return m_pos - begin;
+}
+
+}
@@ -0,0 +1,369 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "uri_scanner.h"
+#include "private/uri_parser_p.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace IdealCore {
+
+static const size_t maxCarrySize = 64 * 1024;
+
+static inline bool isSchemeChar(ichar c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '+' || c == '-' || c == '.';
+}
+
+static inline bool isAlpha(ichar c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/**
+  * @return The position of the first ':' or '.' in [@p pos, @p end). @p end if there is none.
+  */
+static size_t findCandidate(const ichar *str, size_t pos, size_t end)
+{
+#ifdef __SSE2__
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i dot = _mm_set1_epi8('.');
+    while (pos + 16 <= end) {
+        const __m128i block = _mm_loadu_si128((const __m128i*) (str + pos));
+        const iint32 mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, colon),
+                                                           _mm_cmpeq_epi8(block, dot)));
+        if (mask) {
+            return pos + __builtin_ctz(mask);
+        }
+        pos += 16;
+    }
+#endif
+    for (; pos < end; ++pos) {
+        if (str[pos] == ':' || str[pos] == '.') {
+            return pos;
+        }
+    }
+    return end;
+}
+
+class UriScanner::Private
+{
+public:
+    Private();
+    ~Private();
+
+    enum CandidateKind {
+        Authority = 0,
+        Mailto,
+        Www
+    };
+
+    void appendCarry(const ichar *str, size_t size);
+    void scanBuffer(const ichar *str, size_t begin, size_t end, iuint64 offset);
+    size_t parseCandidate(const ichar *str, size_t size, CandidateKind kind,
+                          UriParser::Components &components) const;
+    void addMatch(const ichar *str, size_t length, iuint64 offset,
+                  const UriParser::Components &components);
+
+    ichar         *m_carry;
+    size_t         m_carrySize;
+    size_t         m_carryCapacity;
+    iuint64        m_carryOffset;
+    iuint64        m_offset;
+    Vector<Match>  m_matches;
+};
+
+UriScanner::Private::Private()
+    : m_carry(0)
+    , m_carrySize(0)
+    , m_carryCapacity(0)
+    , m_carryOffset(0)
+    , m_offset(0)
+{
+}
+
+UriScanner::Private::~Private()
+{
+    free(m_carry);
+}
+
+void UriScanner::Private::appendCarry(const ichar *str, size_t size)
+{
+    if (m_carrySize + size > m_carryCapacity) {
+        m_carryCapacity = (m_carrySize + size) * 2;
+        m_carry = (ichar*) realloc(m_carry, m_carryCapacity);
+    }
+    memcpy(m_carry + m_carrySize, str, size);
+    m_carrySize += size;
+    if (m_carrySize > maxCarrySize) {
+        const size_t dropped = m_carrySize - maxCarrySize;
+        memmove(m_carry, m_carry + dropped, maxCarrySize);
+        m_carrySize = maxCarrySize;
+        m_carryOffset += dropped;
+    }
+}
+
+void UriScanner::Private::scanBuffer(const ichar *str, size_t begin, size_t end, iuint64 offset)
+{
+    // Candidates never start before floor: either it is the beginning of the buffer, or the
+    // character at floor cannot be part of a URI, or a previous match ends there.
+    size_t floor = begin;
+    size_t pos = begin;
+    UriParser::Components components;
+    while ((pos = findCandidate(str, pos, end)) < end) {
+        size_t start;
+        CandidateKind kind;
+        if (str[pos] == ':') {
+            if (pos + 2 < end && str[pos + 1] == '/' && str[pos + 2] == '/') {
+                start = pos;
+                while (start > floor && isSchemeChar(str[start - 1])) {
+                    --start;
+                }
+                // A scheme has to start with a letter
+                while (start < pos && !isAlpha(str[start])) {
+                    ++start;
+                }
+                kind = Authority;
+            } else if (pos >= floor + 6 && !strncasecmp(str + pos - 6, "mailto", 6)) {
+                start = pos - 6;
+                kind = Mailto;
+            } else {
+                ++pos;
+                continue;
+            }
+        } else if (pos >= floor + 3 && !strncasecmp(str + pos - 3, "www", 3)) {
+            start = pos - 3;
+            kind = Www;
+        } else {
+            ++pos;
+            continue;
+        }
+        if (start == pos || (kind != Authority && start > floor && isSchemeChar(str[start - 1]))) {
+            ++pos;
+            continue;
+        }
+        const size_t length = parseCandidate(str + start, end - start, kind, components);
+        if (!length) {
+            ++pos;
+            continue;
+        }
+        addMatch(str + start, length, offset + start, components);
+        pos = floor = start + length;
+    }
+}
+
+size_t UriScanner::Private::parseCandidate(const ichar *str, size_t size, CandidateKind kind,
+                                           UriParser::Components &components) const
+{
+    // Each iteration removes trailing punctuation, so this loop always ends
+    while (true) {
+        UriParser uriParser(str, size, UriParser::Strict);
+        size_t length;
+        if (kind == Www) {
+            length = uriParser.parseAuthorityPrefix(components);
+        } else {
+            length = uriParser.parseUri(components);
+        }
+        // Require something after "scheme://", "mailto:" or "www."
+        bool valid;
+        switch (kind) {
+            case Authority:
+                valid = length > components.length[UriParser::Scheme] + 3;
+                break;
+            case Mailto:
+                valid = components.length[UriParser::Path] > 0;
+                break;
+            default:
+                valid = components.length[UriParser::Host] > 4;
+                break;
+        }
+        if (!valid) {
+            return 0;
+        }
+        // Remove trailing punctuation and parse again, so components do not include it
+        size_t trimmed = length;
+        while (trimmed) {
+            const ichar c = str[trimmed - 1];
+            if (strchr(".,;:!?'", c)) {
+                --trimmed;
+                continue;
+            }
+            if (c == ')' && !memchr(str, '(', trimmed)) {
+                --trimmed;
+                continue;
+            }
+            break;
+        }
+        if (trimmed == length) {
+            return length;
+        }
+        size = trimmed;
+    }
+}
+
+void UriScanner::Private::addMatch(const ichar *str, size_t length, iuint64 offset,
+                                   const UriParser::Components &components)
+{
+    Match match;
+    match.m_offset = offset;
+    // String needs a nul terminated buffer
+    ichar *const text = (ichar*) malloc(length + 1);
+    memcpy(text, str, length);
+    text[length] = '\0';
+    match.m_text = text;
+    free(text);
+    for (size_t i = 0; i < UriParser::ComponentCount; ++i) {
+        if (components.begin[i] == UriParser::npos) {
+            match.m_begin[i] = 0xffffffff;
+            match.m_length[i] = 0;
+        } else {
+            match.m_begin[i] = components.begin[i];
+            match.m_length[i] = components.length[i];
+        }
+    }
+    match.m_port = components.port;
+    m_matches.append(match);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+UriScanner::Match::Match()
+    : m_offset(0)
+    , m_port(-1)
+{
+    for (size_t i = 0; i < UriParser::ComponentCount; ++i) {
+        m_begin[i] = 0xffffffff;
+        m_length[i] = 0;
+    }
+}
+
+iuint64 UriScanner::Match::offset() const
+{
+    return m_offset;
+}
+
+size_t UriScanner::Match::length() const
+{
+    return m_text.size();
+}
+
+String UriScanner::Match::text() const
+{
+    return m_text;
+}
+
+bool UriScanner::Match::hasComponent(Component component) const
+{
+    return m_begin[component] != 0xffffffff;
+}
+
+String UriScanner::Match::component(Component component) const
+{
+    if (!m_length[component]) {
+        return String();
+    }
+    // Matches only contain ASCII characters, so characters and bytes are the same
+    return m_text.substr(m_begin[component], m_length[component]);
+}
+
+iint32 UriScanner::Match::port() const
+{
+    return m_port;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+UriScanner::UriScanner()
+    : d(new Private)
+{
+}
+
+UriScanner::~UriScanner()
+{
+    delete d;
+}
+
+void UriScanner::scan(const ichar *chunk, size_t size)
+{
+    size_t begin = 0;
+    if (d->m_carrySize) {
+        // Complete the URI that could be crossing the boundary with the previous chunk. It ends
+        // at the first character that cannot be part of a URI.
+        while (begin < size && UriParser::isUriCharacter(chunk[begin])) {
+            ++begin;
+        }
+        if (begin == size) {
+            d->appendCarry(chunk, size);
+            d->m_offset += size;
+            return;
+        }
+        d->appendCarry(chunk, begin + 1);
+        d->scanBuffer(d->m_carry, 0, d->m_carrySize, d->m_carryOffset);
+        d->m_carrySize = 0;
+    }
+    // The URI characters at the end of the chunk could be the beginning of a URI that continues
+    // in the next chunk. They are scanned once we know where they end.
+    size_t end = size;
+    while (end > begin && UriParser::isUriCharacter(chunk[end - 1])) {
+        --end;
+    }
+    d->scanBuffer(chunk, begin, end, d->m_offset);
+    d->m_carryOffset = d->m_offset + end;
+    d->appendCarry(chunk + end, size - end);
+    d->m_offset += size;
+}
+
+void UriScanner::finish()
+{
+    d->scanBuffer(d->m_carry, 0, d->m_carrySize, d->m_carryOffset);
+    d->m_carrySize = 0;
+}
+
+void UriScanner::reset()
+{
+    d->m_carrySize = 0;
+    d->m_carryOffset = 0;
+    d->m_offset = 0;
+    d->m_matches.clear();
+}
+
+size_t UriScanner::matchCount() const
+{
+    return d->m_matches.count();
+}
+
+const UriScanner::Match &UriScanner::match(size_t i) const
+{
+    return d->m_matches[i];
+}
+
+void UriScanner::clearMatches()
+{
+    d->m_matches.clear();
+}
+
+}
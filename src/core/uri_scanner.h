@@ -0,0 +1,172 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2011 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef URI_SCANNER_H
+#define URI_SCANNER_H
+
+#include <ideal_export.h>
+#include <core/ideal_string.h>
+#include <core/vector.h>
+
+namespace IdealCore {
+
+/**
+  * @class UriScanner uri_scanner.h core/uri_scanner.h
+  *
+  * This class finds URIs embedded in text. The text can be given at once or in chunks of any size,
+  * as it is read from a file or a socket. URIs crossing the boundary between two chunks are found
+  * as if the text had been given at once:
+  *
+  * @code
+  * UriScanner scanner;
+  * while ((size = read(fd, buffer, sizeof(buffer))) > 0) {
+  *     scanner.scan(buffer, size);
+  *     for (size_t i = 0; i < scanner.matchCount(); ++i) {
+  *         IDEAL_SDEBUG(scanner.match(i).offset() << ": " << scanner.match(i).text());
+  *     }
+  *     scanner.clearMatches();
+  * }
+  * scanner.finish();
+  * @endcode
+  *
+  * Only three kind of candidates are considered: URIs with an authority ("scheme://..."), "mailto:"
+  * URIs and host names starting with "www." (e.g. "www.example.com/index.html"). From each
+  * candidate the longest URI allowed by RFC 3986 is taken, without accepting characters that should
+  * have been percent encoded. Punctuation that usually follows a URI in text (".,;:!?'" and an
+  * unbalanced ')') is not considered part of it.
+  *
+  * @note Text is scanned 16 bytes at a time looking for ':' and '.', and the grammar is only run
+  *       where those characters start a candidate, so most of the text is only read once.
+  *
+  * @note A URI crossing a chunk boundary is kept in an internal buffer until it ends. If a URI
+  *       crossing a chunk boundary is longer than 64 KiB, only its last 64 KiB are scanned.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT UriScanner
+{
+public:
+    enum Component {
+        Scheme = 0,     ///< The scheme, without the ':'.
+        UserInfo,       ///< The user information, without the '@'.
+        Host,           ///< The host. IPv6 addresses are reported without brackets.
+        Port,           ///< The port digits, without the ':'.
+        Path,           ///< The path.
+        Query,          ///< The query, without the '?'.
+        Fragment        ///< The fragment, without the '#'.
+    };
+
+    /**
+      * @class Match uri_scanner.h core/uri_scanner.h
+      *
+      * A URI found by UriScanner.
+      */
+    class IDEAL_EXPORT Match
+    {
+    public:
+        Match();
+
+        /**
+          * @return The offset of this URI from the beginning of the text, counting all chunks.
+          */
+        iuint64 offset() const;
+
+        /**
+          * @return The length in bytes of this URI.
+          */
+        size_t length() const;
+
+        /**
+          * @return This URI as it appears in the text.
+          */
+        String text() const;
+
+        /**
+          * @return Whether this URI has the component @p component. "www." URIs have no scheme.
+          */
+        bool hasComponent(Component component) const;
+
+        /**
+          * @return @p component of this URI as it appears in the text. An empty string if it is
+          *         not present.
+          */
+        String component(Component component) const;
+
+        /**
+          * @return The port of this URI. -1 if no port was specified.
+          */
+        iint32 port() const;
+
+    private:
+        friend class UriScanner;
+
+        iuint64 m_offset;
+        String  m_text;
+        iuint32 m_begin[7];
+        iuint32 m_length[7];
+        iint32  m_port;
+    };
+
+    UriScanner();
+    virtual ~UriScanner();
+
+    /**
+      * Scans the next @p size bytes of text. URIs that end in this chunk are appended to the list of
+      * matches. A URI that reaches the end of the chunk is reported once the next chunk shows where
+      * it ends, or when finish() is called.
+      */
+    void scan(const ichar *chunk, size_t size);
+
+    /**
+      * Signals the end of the text. A URI that reached the end of the last chunk is reported now.
+      */
+    void finish();
+
+    /**
+      * Forgets all text and matches, so a new text can be scanned.
+      */
+    void reset();
+
+    /**
+      * @return The number of matches found since the last call to clearMatches().
+      */
+    size_t matchCount() const;
+
+    /**
+      * @return The match @p i, in the same order URIs appear in the text.
+      */
+    const Match &match(size_t i) const;
+
+    /**
+      * Removes all matches found so far. Text already scanned is not scanned again.
+      */
+    void clearMatches();
+
+private:
+    UriScanner(const UriScanner &uriScanner);
+    UriScanner &operator=(const UriScanner &uriScanner);
+
+    class Private;
+    Private *d;
+};
+
+}
+
+#endif //URI_SCANNER_H
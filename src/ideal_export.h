@@ -26,7 +26,9 @@
 #include <iostream>
 
 #define IDEAL_SIGNAL(name, ...) const IdealCore::Signal<__VA_ARGS__> name
-#define IDEAL_SIGNAL_INIT(name, ...) name(IdealCore::Signal<__VA_ARGS__>(this, #name, #__VA_ARGS__))
+#define IDEAL_SIGNAL_INIT(name, ...) name(this, #name, #__VA_ARGS__)
+#define IDEAL_STATIC_SIGNAL(name, slots, ...) const IdealCore::StaticSignal<slots, ##__VA_ARGS__> name
+#define IDEAL_STATIC_SLOT(slot) IdealCore::StaticSlot<decltype(slot), slot>
 
 #ifndef __GNUC__
 #define __attribute__(x)